@@ -0,0 +1,308 @@
+//*************************************************************************
+// Ryan Scaglione
+// z1996413
+// CSCI463 - PE1
+//
+// I certify that this is my own work, and where applicable an extension
+// of the starter code for the assignment
+//
+//*************************************************************************
+
+/*************************************************************************
+cpu_multi_hart.cpp
+
+Implementation of the cpu_multi_hart class, a CPU made of several harts
+sharing one memory. The harts either run on host threads of their own or
+take turns on the calling thread, a quantum at a time, which gives the
+same interleaving on every run.
+
+*************************************************************************/
+
+#include "cpu_multi_hart.h"
+#include <iostream>
+#include <algorithm>
+#include <thread>
+
+/*************************************************************************
+Function: cpu_multi_hart
+
+Use: Constructs the CPU, giving each hart its index as its mhartid.
+
+Arguments:
+1. memory &m: The memory all of the harts run out of.
+2. uint32_t hart_count: How many harts to make, at least one.
+3. uint32_t exec_limit: The most instructions run() executes on each hart,
+   0 for no limit.
+
+ ************************************************************************/
+cpu_multi_hart::cpu_multi_hart(memory &m, uint32_t hart_count, uint32_t exec_limit)
+    : execution_limit(exec_limit), sched(sched_threads), quantum(default_quantum),
+      stop_requested(false)
+{
+    for(uint32_t i = 0; i < std::max(hart_count, 1u); i++) {
+        cpus.emplace_back(m, exec_limit);
+        cpus.back().get_hart().set_mhartid(i);
+    }
+}
+
+/*************************************************************************
+Function: get_hart_count
+
+Use: Accessor for the number of harts.
+
+Arguments: None
+
+Returns: uint32_t: The number of harts.
+
+ ************************************************************************/
+uint32_t cpu_multi_hart::get_hart_count() const
+{
+    return cpus.size();
+}
+
+/*************************************************************************
+Function: get_hart
+
+Use: Accessor for one hart, e.g. to set its pc or pick its core.
+
+Arguments:
+1. uint32_t i: The hart's mhartid.
+
+Returns: rv32i_hart&: The hart.
+
+ ************************************************************************/
+rv32i_hart& cpu_multi_hart::get_hart(uint32_t i)
+{
+    return cpus[i].get_hart();
+}
+
+/*************************************************************************
+Function: run
+
+Use: Runs every hart until it halts or has executed the execution limit,
+     then reports for each one why it stopped and how many instructions
+     it executed.
+
+Arguments: None
+
+ ************************************************************************/
+void cpu_multi_hart::run()
+{
+    std::vector<uint64_t> left(cpus.size(), UINT64_MAX);
+    if(execution_limit != 0) {
+        for(size_t i = 0; i < cpus.size(); i++) {
+            uint64_t done = cpus[i].get_hart().get_insn_counter();
+            left[i] = (done < execution_limit) ? execution_limit - done : 0;
+        }
+    }
+    if(sched == sched_round_robin) {
+        run_round_robin(left);
+    }
+    else {
+        run_threads(left);
+    }
+
+    for(size_t i = 0; i < cpus.size(); i++) {
+        rv32i_hart &h = cpus[i].get_hart();
+        if(h.is_halted()) {
+            std::cout << "Hart " << i << ": Execution terminated. Reason: " << h.get_halt_reason() << std::endl;
+        }
+        std::cout << "Hart " << i << ": " << h.get_insn_counter() << " instructions executed" << std::endl;
+    }
+}
+
+/*************************************************************************
+Function: run_for
+
+Use: Executes up to n instructions on each hart.
+
+Arguments:
+1. uint64_t n: The most instructions to execute on each hart.
+
+Returns: uint64_t: The number of instructions that retired on all of the
+     harts together.
+
+Notes: a hart stops short of n only if it halts or a stop is requested.
+
+ ************************************************************************/
+uint64_t cpu_multi_hart::run_for(uint64_t n)
+{
+    std::vector<uint64_t> left(cpus.size(), n);
+    if(sched == sched_round_robin) {
+        return run_round_robin(left);
+    }
+    return run_threads(left);
+}
+
+/*************************************************************************
+Function: request_stop
+
+Use: Asks a run_for() in progress, or the next one, to return early.
+
+Arguments: None
+
+Notes: on threads every hart still running sees it within a slice,
+     round robin stops at the end of the current quantum. Either way the
+     request is used up by the run_for() it stops.
+
+ ************************************************************************/
+void cpu_multi_hart::request_stop()
+{
+    stop_requested.store(true, std::memory_order_relaxed);
+}
+
+/*************************************************************************
+Function: run_threads
+
+Use: Runs each hart on a host thread of its own until its budget is used
+     up, it halts or a stop is requested.
+
+Arguments:
+1. std::vector<uint64_t> &left: Each hart's budget, less what it ran on
+   return.
+
+Returns: uint64_t: The number of instructions that retired in all.
+
+Notes: the harts race each other the way real cores do, so anything they
+     share in memory interleaves differently from run to run. They all
+     watch the one stop_requested, which is cleared once they are joined,
+     so a hart that finished early is not left holding a stale stop.
+
+ ************************************************************************/
+uint64_t cpu_multi_hart::run_threads(std::vector<uint64_t> &left)
+{
+    std::vector<uint64_t> done(cpus.size(), 0);
+    std::vector<std::thread> threads;
+    for(size_t i = 1; i < cpus.size(); i++) {
+        threads.emplace_back([this, &left, &done, i]() {
+            done[i] = cpus[i].run_for(left[i], &stop_requested);
+        });
+    }
+    // hart 0 runs on the calling thread
+    done[0] = cpus[0].run_for(left[0], &stop_requested);
+    for(std::thread &t : threads) {
+        t.join();
+    }
+    stop_requested.store(false, std::memory_order_relaxed);
+
+    uint64_t total = 0;
+    for(size_t i = 0; i < cpus.size(); i++) {
+        left[i] -= done[i];
+        total += done[i];
+    }
+    return total;
+}
+
+/*************************************************************************
+Function: run_round_robin
+
+Use: Runs the harts in turn on the calling thread, quantum instructions
+     at a time, until each has used up its budget or halted or a stop is
+     requested.
+
+Arguments:
+1. std::vector<uint64_t> &left: Each hart's budget, less what it ran on
+   return.
+
+Returns: uint64_t: The number of instructions that retired in all.
+
+Notes: the harts always switch at the same instruction counts, so a run
+     repeats exactly as long as the guest does not read the time CSR.
+
+ ************************************************************************/
+uint64_t cpu_multi_hart::run_round_robin(std::vector<uint64_t> &left)
+{
+    uint64_t total = 0;
+    bool running = true;
+    while(running) {
+        running = false;
+        for(size_t i = 0; i < cpus.size(); i++) {
+            if(left[i] == 0 || cpus[i].get_hart().is_halted()) {
+                continue;
+            }
+            if(stop_requested.exchange(false, std::memory_order_relaxed)) {
+                return total;
+            }
+            uint64_t done = cpus[i].run_for(std::min(left[i], quantum));
+            left[i] -= done;
+            total += done;
+            running = true;
+        }
+    }
+    return total;
+}
+
+/*************************************************************************
+Function: set_schedule
+
+Use: Mutator for how the harts share the host.
+
+Arguments:
+1. schedule s: sched_threads or sched_round_robin.
+
+ ************************************************************************/
+void cpu_multi_hart::set_schedule(schedule s)
+{
+    sched = s;
+}
+
+/*************************************************************************
+Function: set_quantum
+
+Use: Mutator for how many instructions a hart runs per turn under
+     sched_round_robin.
+
+Arguments:
+1. uint64_t q: The quantum, at least 1.
+
+ ************************************************************************/
+void cpu_multi_hart::set_quantum(uint64_t q)
+{
+    quantum = std::max<uint64_t>(q, 1);
+}
+
+/*************************************************************************
+Function: set_exec_limit
+
+Use: Mutator for the per hart execution limit used by run().
+
+Arguments:
+1. uint32_t limit: The most instructions to execute, 0 for no limit.
+
+ ************************************************************************/
+void cpu_multi_hart::set_exec_limit(uint32_t limit)
+{
+    execution_limit = limit;
+}
+
+/*************************************************************************
+Function: set_show_instructions
+
+Use: Traces each instruction as it executes, on every hart.
+
+Arguments:
+1. bool b: true to trace.
+
+ ************************************************************************/
+void cpu_multi_hart::set_show_instructions(bool b)
+{
+    for(cpu_single_hart &c : cpus) {
+        c.set_show_instructions(b);
+    }
+}
+
+/*************************************************************************
+Function: set_show_registers
+
+Use: Dumps the registers before each instruction executes, on every hart.
+
+Arguments:
+1. bool b: true to dump them.
+
+ ************************************************************************/
+void cpu_multi_hart::set_show_registers(bool b)
+{
+    for(cpu_single_hart &c : cpus) {
+        c.set_show_registers(b);
+    }
+}
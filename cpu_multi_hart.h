@@ -0,0 +1,68 @@
+//*************************************************************************
+// Ryan Scaglione
+// z1996413
+// CSCI463 - PE1
+//
+// I certify that this is my own work, and where applicable an extension
+// of the starter code for the assignment
+//
+//*************************************************************************
+
+#ifndef CPU_MULTI_HART_H
+#define CPU_MULTI_HART_H
+
+#include <cstdint>
+#include <atomic>
+#include <deque>
+#include <vector>
+
+#include "cpu_single_hart.h"
+#include "memory.h"
+
+class cpu_multi_hart
+{
+public:
+    // How the harts share the host
+    enum schedule
+    {
+        sched_threads,      // one host thread per hart, as fast as they go
+        sched_round_robin   // one host thread, each hart in turn for a quantum
+    };
+
+    // Constructor, hart i gets mhartid i
+    cpu_multi_hart(memory &m, uint32_t hart_count, uint32_t exec_limit = 0);
+
+    // Getters for the harts
+    uint32_t get_hart_count() const;
+    rv32i_hart& get_hart(uint32_t i);
+
+    // Run the simulation
+    void run();
+
+    // Run up to n instructions on every hart, returns how many retired in all
+    uint64_t run_for(uint64_t n);
+
+    // Make a run_for() in progress return early, safe from another thread
+    void request_stop();
+
+    // Setters for simulation parameters
+    void set_schedule(schedule s);
+    void set_quantum(uint64_t q);
+    void set_exec_limit(uint32_t limit);
+    void set_show_instructions(bool b);
+    void set_show_registers(bool b);
+
+private:
+    static const uint64_t default_quantum = 1000;
+
+    std::deque<cpu_single_hart> cpus;   // one per hart, all on the same memory
+    uint32_t execution_limit;
+    schedule sched;
+    uint64_t quantum;
+    std::atomic<bool> stop_requested;
+
+    uint64_t run_threads(std::vector<uint64_t> &left);
+    uint64_t run_round_robin(std::vector<uint64_t> &left);
+};
+
+#endif // CPU_MULTI_HART_H
@@ -12,6 +12,9 @@
 #ifndef CPU_SINGLE_HART_H
 #define CPU_SINGLE_HART_H
 
+#include <cstdint>
+#include <atomic>
+
 #include "rv32i_hart.h"
 #include "memory.h"
 
@@ -27,14 +30,26 @@ public:
     // Run the simulation
     void run();
 
+    // Run up to n instructions, returns how many retired. A shared flag,
+    // if given, also stops it while set, without being cleared
+    uint64_t run_for(uint64_t n, const std::atomic<bool> *shared_stop = nullptr);
+
+    // Make a run_for() in progress return early, safe from another thread
+    void request_stop();
+
     // Setters for simulation parameters
     void set_exec_limit(uint32_t limit);
     void set_show_instructions(bool b);
     void set_show_registers(bool b);
 
 private:
+    // run_for() hands the hart this much of its budget at a time and looks
+    // for a stop request in between
+    static const uint64_t slice = 1u << 16;
+
     rv32i_hart hart;            // Single hart instance
     uint32_t execution_limit;   
+    std::atomic<bool> stop_requested;
 };
 
 #endif // CPU_SINGLE_HART_H
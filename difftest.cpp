@@ -0,0 +1,791 @@
+//*************************************************************************
+// Ryan Scaglione
+// z1996413
+// CSCI463 - PE1
+//
+// I certify that this is my own work, and where applicable an extension
+// of the starter code for the assignment
+//
+//*************************************************************************
+
+/*************************************************************************
+difftest.cpp
+
+A differential test driver for the execution cores. Every program is run
+by traced tick() calls, which are the reference, and again by each core.
+That is done on paged and on guarded memory, each against its own
+reference, as a guarded fault does not know its width. The registers, pc,
+memory, halt reason and instruction count must come out the same.
+
+The programs are the images named on the command line plus two kinds of
+random instruction stream: straight runs of any instruction, and short
+loops that run long enough for core_block to translate them. Before
+them come directed checks of what every core must report, whatever the
+reference does.
+
+With -a, the AOT path is checked too. It is only a core once its image
+is compiled, so each image named, a program that stores into its own
+code and a few of the random programs are translated into the directory
+given, built with $CXX (g++ by default) against the sources in the
+current directory, and run with a range of execution limits. Its output
+must match tick() run to the same limit.
+
+Build it from the same sources as rv32i, with difftest.cpp in place of
+main.cpp:
+    g++ -std=c++14 -O2 -o difftest difftest.cpp memory.cpp hex.cpp
+        rv32i_decode.cpp rv32i_aot.cpp rv32i_hart.cpp rv32i_jit.cpp
+        registerfile.cpp
+
+*************************************************************************/
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include "memory.h"
+#include "rv32i_decode.h"
+#include "rv32i_hart.h"
+#include "rv32i_aot.h"
+
+using namespace std;
+
+// How a program is run, the first one being the reference
+struct run_mode
+{
+    const char *name;
+    rv32i_hart::exec_core core;
+    bool jit;
+    bool chunked;   // run() in small random slices instead of all at once
+};
+
+static const run_mode modes[] =
+{
+    { "tick",           rv32i_hart::core_switch,   false, false },
+    { "switch",         rv32i_hart::core_switch,   false, false },
+    { "threaded",       rv32i_hart::core_threaded, false, false },
+    { "threaded/slice", rv32i_hart::core_threaded, false, true },
+    { "block",          rv32i_hart::core_block,    false, false },
+    { "block/slice",    rv32i_hart::core_block,    false, true },
+    { "jit",            rv32i_hart::core_block,    true,  false },
+    { "jit/slice",      rv32i_hart::core_block,    true,  true }
+};
+
+static const memory::backing_mode backings[] = { memory::backing_paged, memory::backing_guarded };
+static const char *const backing_names[] = { "paged", "guarded" };
+
+static void usage();
+
+static void usage()
+{
+    cerr << "Usage: difftest [-m hex-mem-size] [-l exec-limit] [-s seed] [-n cases] [-a aot-dir] [infile...]" << endl;
+    cerr << "    -m memory size for the images named (default = 0x1000)" << endl;
+    cerr << "    -l the most instructions any one run executes (default = 100000)" << endl;
+    cerr << "    -s seed for the random programs (default = 1)" << endl;
+    cerr << "    -n how many random programs of each kind to run (default = 500)" << endl;
+    cerr << "    -a also build and check AOT translations, in aot-dir" << endl;
+    exit(1);
+}
+
+/*************************************************************************
+Function: run_hart
+
+Use: Runs a hart the given way, keeping its output off cout.
+
+Arguments:
+1. rv32i_hart &h: The hart, ready to go.
+2. const run_mode &m: The core to run it on.
+3. uint64_t limit: The most instructions to execute.
+4. uint32_t slice_seed: Picks the slice sizes of a chunked run.
+
+ ************************************************************************/
+static void run_hart(rv32i_hart &h, const run_mode &m, uint64_t limit, uint32_t slice_seed)
+{
+    h.set_core(m.core);
+    h.set_jit(m.jit);
+    h.set_show_instructions(&m == &modes[0]);
+
+    // Tracing and halt messages go to cout, which is kept out of the
+    // result, and so are the std::left and fill the trace leaves on it
+    ostringstream sink;
+    streambuf *old = cout.rdbuf(sink.rdbuf());
+    ios::fmtflags flags = cout.flags();
+    char fill = cout.fill();
+
+    if(&m == &modes[0]) {
+        while(!h.is_halted() && h.get_insn_counter() < limit) {
+            h.tick();
+        }
+    }
+    else if(m.chunked) {
+        mt19937 r(slice_seed);
+        while(!h.is_halted() && h.get_insn_counter() < limit) {
+            uint64_t slice = 1 + r() % 97;
+            h.run(min<uint64_t>(slice, limit - h.get_insn_counter()));
+        }
+    }
+    else {
+        h.run(limit);
+    }
+    cout.rdbuf(old);
+    cout.flags(flags);
+    cout.fill(fill);
+}
+
+/*************************************************************************
+Function: run_once
+
+Use: Runs a memory image the given way and captures the state it ends in.
+
+Arguments:
+1. const vector<uint32_t> &image: The program, loaded at address 0.
+2. uint32_t mem_size: Bytes of guest memory.
+3. const run_mode &m: The core to run it on.
+4. memory::backing_mode backing: The memory backing to use.
+5. uint64_t limit: The most instructions to execute.
+6. uint32_t slice_seed: Picks the slice sizes of a chunked run.
+7. bool reset: false to only set the pc of the new hart, the way a
+   caller that never resets it would.
+
+Returns: string: The register dump, memory dump, halt reason and
+     instruction count, to compare against the reference.
+
+ ************************************************************************/
+static string run_once(const vector<uint32_t> &image, uint32_t mem_size, const run_mode &m,
+                       memory::backing_mode backing, uint64_t limit, uint32_t slice_seed, bool reset = true)
+{
+    memory mem(mem_size, backing);
+    mem.set_fault_warnings(0);
+    mem.write_block(0, image.data(), static_cast<uint32_t>(min<size_t>(image.size() * 4, mem_size)));
+
+    rv32i_hart h(mem);
+    if(reset) {
+        h.reset();
+    }
+    else {
+        h.set_pc(0);
+    }
+    run_hart(h, m, limit, slice_seed);
+
+    ostringstream state;
+    streambuf *old = cout.rdbuf(state.rdbuf());
+    h.dump();
+    mem.dump(0, mem_size, true);
+    cout.rdbuf(old);
+
+    state << h.get_halt_reason() << endl << h.get_insn_counter() << " instructions" << endl;
+    return state.str();
+}
+
+/*************************************************************************
+Function: check
+
+Use: Runs a program every way there is and reports each run that does
+     not end in the same state as the reference.
+
+Arguments:
+1. const string &what: Names the program in the report.
+2. const vector<uint32_t> &image: The program, loaded at address 0.
+3. uint32_t mem_size: Bytes of guest memory.
+4. uint64_t limit: The most instructions any one run executes.
+5. uint32_t slice_seed: Picks the slice sizes of chunked runs.
+
+Returns: bool: true if every run agrees with the reference.
+
+ ************************************************************************/
+static bool check(const string &what, const vector<uint32_t> &image, uint32_t mem_size,
+                  uint64_t limit, uint32_t slice_seed)
+{
+    bool ok = true;
+    for(size_t b = 0; b < sizeof(backings) / sizeof(backings[0]); b++) {
+        string want = run_once(image, mem_size, modes[0], backings[b], limit, slice_seed);
+        for(const run_mode &m : modes) {
+            if(&m == &modes[0]) {
+                continue;
+            }
+            string got = run_once(image, mem_size, m, backings[b], limit, slice_seed);
+            if(got != want) {
+                cout << what << ": " << m.name << " on " << backing_names[b] << " memory differs from tick()" << endl;
+                cout << "--- tick()" << endl << want << "--- " << m.name << endl << got;
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+// Instruction encoders for the random programs
+static uint32_t enc_i(uint32_t op, uint32_t rd, uint32_t f3, uint32_t rs1, uint32_t imm)
+{
+    return (imm & 0xfff) << 20 | rs1 << 15 | f3 << 12 | rd << 7 | op;
+}
+
+static uint32_t enc_r(uint32_t f7, uint32_t rs2, uint32_t rs1, uint32_t f3, uint32_t rd)
+{
+    return f7 << 25 | rs2 << 20 | rs1 << 15 | f3 << 12 | rd << 7 | 0x33;
+}
+
+static uint32_t enc_s(uint32_t rs1, uint32_t rs2, uint32_t f3, uint32_t imm)
+{
+    return ((imm >> 5) & 0x7f) << 25 | rs2 << 20 | rs1 << 15 | f3 << 12 | (imm & 0x1f) << 7 | 0x23;
+}
+
+static uint32_t enc_b(uint32_t f3, uint32_t rs1, uint32_t rs2, int32_t offset)
+{
+    uint32_t u = static_cast<uint32_t>(offset);
+    return ((u >> 12) & 1) << 31 | ((u >> 5) & 0x3f) << 25 | rs2 << 20 | rs1 << 15 | f3 << 12 |
+           ((u >> 1) & 0xf) << 8 | ((u >> 11) & 1) << 7 | 0x63;
+}
+
+static uint32_t enc_j(uint32_t rd, int32_t offset)
+{
+    uint32_t u = static_cast<uint32_t>(offset);
+    return ((u >> 20) & 1) << 31 | ((u >> 1) & 0x3ff) << 21 | ((u >> 11) & 1) << 20 |
+           ((u >> 12) & 0xff) << 12 | rd << 7 | 0x6f;
+}
+
+static const uint32_t branch_f3[] = { 0, 1, 4, 5, 6, 7 };
+
+/*************************************************************************
+Function: random_amo
+
+Use: Makes a random lr.w, sc.w or AMO.
+
+Arguments:
+1. mt19937 &r: The random source.
+2. uint32_t rd, rs1, rs2: The registers to use, rs1 holding the address.
+
+Returns: uint32_t: The instruction.
+
+ ************************************************************************/
+static uint32_t random_amo(mt19937 &r, uint32_t rd, uint32_t rs1, uint32_t rs2)
+{
+    static const uint32_t funct5[] = { 0x02, 0x03, 0x01, 0x00, 0x04, 0x0c, 0x08, 0x10, 0x14, 0x18, 0x1c };
+    uint32_t f5 = funct5[r() % (sizeof(funct5) / sizeof(funct5[0]))];
+    return f5 << 27 | (f5 == 0x02 ? 0 : rs2) << 20 | rs1 << 15 | 2 << 12 | rd << 7 | 0x2f;
+}
+
+/*************************************************************************
+Function: random_alu
+
+Use: Makes a random register-only instruction, from RV32I, M, Zba or Zbb.
+
+Arguments:
+1. mt19937 &r: The random source.
+2. uint32_t rd, rs1, rs2: The registers to use.
+
+Returns: uint32_t: The instruction.
+
+ ************************************************************************/
+static uint32_t random_alu(mt19937 &r, uint32_t rd, uint32_t rs1, uint32_t rs2)
+{
+    // Zba and Zbb, with the register fields clear
+    static const uint32_t zb[] =
+    {
+        0x20002033, 0x20004033, 0x20006033, 0x40007033, 0x40006033, 0x40004033,
+        0x60001013, 0x60101013, 0x60201013, 0x60401013, 0x60501013, 0x0a004033,
+        0x0a005033, 0x0a006033, 0x0a007033, 0x08004033, 0x60001033, 0x60005033,
+        0x60005013, 0x69805013, 0x28705013
+    };
+    static const uint32_t alu_f3[] = { 0, 2, 3, 4, 6, 7 };
+
+    switch(r() % 6) {
+        case 0:
+        case 1:
+            return enc_i(0x13, rd, alu_f3[r() % 6], rs1, r());
+        case 2:
+        {
+            uint32_t f3 = r() % 2 ? 1 : 5;
+            return enc_i(0x13, rd, f3, rs1, (r() % 32) | ((f3 == 5 && r() % 2) ? 0x400 : 0));
+        }
+        case 3:
+        {
+            uint32_t f3 = r() % 8;
+            return enc_r(((f3 == 0 || f3 == 5) && r() % 2) ? 0x20 : 0, rs2, rs1, f3, rd);
+        }
+        case 4:
+            return enc_r(0x01, rs2, rs1, r() % 8, rd);     // M
+        default:
+        {
+            uint32_t w = zb[r() % (sizeof(zb) / sizeof(zb[0]))];
+            if(w == 0x60005013) {
+                w |= (r() % 32) << 20;                      // rori shamt
+            }
+            else if((w & 0x7f) == 0x33 && w != 0x08004033) {
+                w |= rs2 << 20;                             // all but zext.h take rs2
+            }
+            return w | rs1 << 15 | rd << 7;
+        }
+    }
+}
+
+/*************************************************************************
+Function: random_stream
+
+Use: Makes a program of random instructions of every kind. Loads, stores
+     and atomics stay near address 0 so that some of them hit the
+     program itself, and jumps and branches stay near where they are.
+
+Arguments:
+1. mt19937 &r: The random source.
+
+Returns: vector<uint32_t>: 256 instructions.
+
+ ************************************************************************/
+static vector<uint32_t> random_stream(mt19937 &r)
+{
+    static const uint32_t csrs[] = { 0x340, 0xc00, 0xc02, 0xc82 };
+    vector<uint32_t> p(256);
+    for(uint32_t &w : p) {
+        uint32_t rd = r() % 32, rs1 = r() % 32, rs2 = r() % 32;
+        switch(r() % 12) {
+            case 0:
+                w = (r() & 0xfffff000) | rd << 7 | (r() % 2 ? 0x37 : 0x17);   // lui, auipc
+                break;
+            case 1:
+                w = enc_j(rd, (static_cast<int32_t>(r() % 64) - 32) * 4);
+                break;
+            case 2:
+                w = enc_i(0x67, rd, 0, 0, (r() % 0x200) & ~3u);                 // jalr off x0
+                break;
+            case 3:
+                w = enc_b(branch_f3[r() % 6], rs1, rs2, (static_cast<int32_t>(r() % 64) - 32) * 4);
+                break;
+            case 4:
+            {
+                static const uint32_t f3s[] = { 0, 1, 2, 4, 5 };
+                w = enc_i(0x03, rd, f3s[r() % 5], 0, r() % 0x200);             // loads, some misaligned
+                break;
+            }
+            case 5:
+                w = enc_s(0, rs2, r() % 3, r() % 0x200);
+                break;
+            case 6:
+                // through x0, at the program itself, or x1, wherever it points
+                w = random_amo(r, rd, r() % 2, rs2);
+                break;
+            case 7:
+                w = enc_i(0x73, rd, 1 + r() % 7, rs1, csrs[r() % 4]);
+                if(((w >> 12) & 7) == 4) {
+                    w = 0x00100073;                                             // ebreak
+                }
+                break;
+            default:
+                w = random_alu(r, rd, rs1, rs2);
+                break;
+        }
+    }
+    return p;
+}
+
+/*************************************************************************
+Function: random_loop
+
+Use: Makes a loop of random straight line code followed by a blt back to
+     its top, run enough times to get hot. The loads, stores and atomics
+     go through x29, which points at data past the code, at the very end
+     of memory, or over the loop itself.
+
+Arguments:
+1. mt19937 &r: The random source.
+
+Returns: vector<uint32_t>: The program, padded to 512 words.
+
+ ************************************************************************/
+static vector<uint32_t> random_loop(mt19937 &r)
+{
+    vector<uint32_t> p;
+    // x31 counts the trips, x30 is their number
+    p.push_back(enc_i(0x13, 30, 0, 0, 20 + r() % 60));
+    switch(r() % 8) {
+        case 0:  p.push_back(enc_i(0x13, 29, 0, 0, 0x7f0)); break;
+        case 1:  p.push_back(enc_i(0x13, 29, 0, 0, 0x010)); break;
+        default: p.push_back(enc_i(0x13, 29, 0, 0, 0x400 + (r() % 4) * 0x100)); break;
+    }
+    size_t top = p.size();
+
+    int body = 3 + r() % 30;
+    for(int i = 0; i < body; i++) {
+        uint32_t rd = 1 + r() % 28, rs1 = r() % 29, rs2 = r() % 29, k = r() % 100;
+        if(k < 70) {
+            p.push_back(random_alu(r, rd, rs1, rs2));
+        }
+        else if(k < 75) {
+            p.push_back((r() & 0xfffff000) | rd << 7 | (r() % 2 ? 0x37 : 0x17));
+        }
+        else if(k < 85) {
+            static const uint32_t f3s[] = { 0, 1, 2, 4, 5 };
+            uint32_t f3 = f3s[r() % 5];
+            p.push_back(enc_i(0x03, rd, f3, 29, (r() % 64) & ~((1u << (f3 & 3)) - 1)));
+        }
+        else if(k < 95) {
+            uint32_t f3 = r() % 3;
+            p.push_back(enc_s(29, rs2, f3, (r() % 64) & ~((1u << f3) - 1)));
+        }
+        else {
+            p.push_back(random_amo(r, rd, 29, rs2));
+        }
+    }
+
+    p.push_back(enc_i(0x13, 31, 0, 31, 1));
+    p.push_back(enc_b(4, 31, 30, -4 * static_cast<int32_t>(p.size() - top)));
+    p.push_back(r() % 4 ? 0x00100073 : 0x00000073);
+    p.resize(512, 0);
+    return p;
+}
+
+/*************************************************************************
+Function: check_store_faults
+
+Use: Checks that a store past the end of memory is recorded as a write
+     fault, at the right address and in the write counter only, on every
+     core and backing. The store sits in a loop that walks up to the end
+     of memory, so it is hot enough to be translated before it faults.
+
+Returns: int: The number of runs that got it wrong.
+
+ ************************************************************************/
+static int check_store_faults()
+{
+    static const uint32_t mem_size = 0x1000;
+    static const char *const names[] = { "sb", "sh", "sw" };
+    int bad = 0;
+    for(uint32_t f3 = 0; f3 < 3; f3++) {
+        vector<uint32_t> image;
+        image.push_back(0x000010b7);                            // lui x1, 0x1
+        image.push_back(enc_i(0x13, 1, 0, 1, 0xf00));           // addi x1, x1, -0x100
+        image.push_back(enc_s(1, 0, f3, 0));                    // s? x0, 0(x1)
+        image.push_back(enc_i(0x13, 1, 0, 1, 4));               // addi x1, x1, 4
+        image.push_back(enc_j(0, -8));                          // j the store
+        for(size_t b = 0; b < sizeof(backings) / sizeof(backings[0]); b++) {
+            for(const run_mode &m : modes) {
+                memory mem(mem_size, backings[b]);
+                mem.set_fault_warnings(0);
+                mem.write_block(0, image.data(), static_cast<uint32_t>(image.size() * 4));
+                rv32i_hart h(mem);
+                h.reset();
+                run_hart(h, m, 10000, f3);
+
+                const memory::fault &f = h.get_last_fault();
+                if(!h.is_halted() || f.kind != memory::fault_write || f.addr != mem_size || f.pc != 8 ||
+                   mem.get_fault_count(memory::fault_write) != 1 || mem.get_fault_count() != 1) {
+                    cout << names[f3] << " past the end: " << m.name << " on " << backing_names[b]
+                         << " memory does not report a write fault: " << h.get_halt_reason() << endl;
+                    bad++;
+                }
+            }
+        }
+    }
+    return bad;
+}
+
+/*************************************************************************
+Function: check_unreset
+
+Use: Checks that a hart that was never reset, only given its pc, runs
+     a program the same as a reset one, on every core and backing.
+
+Arguments:
+1. const vector<uint32_t> &image: The program, loaded at address 0.
+2. uint32_t mem_size: Bytes of guest memory.
+3. uint64_t limit: The most instructions any one run executes.
+
+Returns: int: The number of runs that differ.
+
+ ************************************************************************/
+static int check_unreset(const vector<uint32_t> &image, uint32_t mem_size, uint64_t limit)
+{
+    int bad = 0;
+    for(size_t b = 0; b < sizeof(backings) / sizeof(backings[0]); b++) {
+        string want = run_once(image, mem_size, modes[0], backings[b], limit, 0);
+        for(const run_mode &m : modes) {
+            if(run_once(image, mem_size, m, backings[b], limit, 0, false) != want) {
+                cout << "without reset(): " << m.name << " on " << backing_names[b]
+                     << " memory differs from a reset hart" << endl;
+                bad++;
+            }
+        }
+    }
+    return bad;
+}
+
+// The simulator sources an AOT image is built with, main.cpp aside
+static const char *const aot_sources[] =
+{
+    "rv32i_aot", "rv32i_hart", "rv32i_jit", "rv32i_decode", "registerfile", "memory", "hex"
+};
+
+/*************************************************************************
+Function: aot_build_objects
+
+Use: Compiles the simulator sources once into dir, for every AOT image
+     to link against.
+
+Arguments:
+1. const string &dir: Where the objects go.
+2. string &objs: Set to the object files, for the link command line.
+
+Returns: bool: false if a source does not compile.
+
+ ************************************************************************/
+static bool aot_build_objects(const string &dir, string &objs)
+{
+    const char *cxx = getenv("CXX");
+    objs.clear();
+    for(const char *src : aot_sources) {
+        string obj = dir + "/" + src + ".o";
+        string cmd = string(cxx ? cxx : "g++") + " -std=c++14 -O1 -c -o " + obj + " " + src + ".cpp";
+        if(system(cmd.c_str()) != 0) {
+            cerr << "Can't build " << src << ".cpp for the AOT images" << endl;
+            return false;
+        }
+        objs += " " + obj;
+    }
+    return true;
+}
+
+/*************************************************************************
+Function: check_aot
+
+Use: Translates a program, builds and runs the result, and checks that
+     it ends where tick() does for each of a range of execution limits.
+     The small limits split blocks at every point, and each run covers
+     the image's fallback to tick() and its exit on stores into code.
+
+Arguments:
+1. const string &what: Names the program in the report.
+2. const vector<uint32_t> &image: The program, loaded at address 0.
+3. uint32_t mem_size: Bytes of guest memory.
+4. const string &dir: Where the translation and its build go.
+5. const string &objs: The simulator objects to link with.
+6. int n: Makes the file names unique.
+
+Returns: bool: true if every run agrees with tick(), or the program has
+     no code to translate.
+
+ ************************************************************************/
+static bool check_aot(const string &what, const vector<uint32_t> &image, uint32_t mem_size,
+                      const string &dir, const string &objs, int n)
+{
+    string base = dir + "/aot_" + to_string(n);
+
+    // The image file, in guest byte order
+    {
+        ofstream bin(base + ".bin", ios::binary);
+        for(uint32_t w : image) {
+            char bytes[4] = { char(w), char(w >> 8), char(w >> 16), char(w >> 24) };
+            bin.write(bytes, 4);
+        }
+    }
+
+    memory mem(mem_size);
+    if(!mem.load_file(base + ".bin")) {
+        cerr << "Can't load " << base << ".bin" << endl;
+        return false;
+    }
+    {
+        ofstream out(base + ".cpp");
+        if(!rv32i_aot::translate(mem, 0, out)) {
+            return true;
+        }
+    }
+    const char *cxx = getenv("CXX");
+    string cmd = string(cxx ? cxx : "g++") + " -std=c++14 -O1 -I. -o " + base + " " + base + ".cpp" + objs;
+    if(system(cmd.c_str()) != 0) {
+        cout << what << ": the AOT translation does not build" << endl;
+        return false;
+    }
+
+    static const uint64_t limits[] =
+    {
+        1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20,
+        50, 100, 333, 1000, 20000
+    };
+    bool ok = true;
+    for(uint64_t limit : limits) {
+        // What rv32i_aot::main prints, from tick() alone
+        memory ref_mem(mem_size);
+        ref_mem.set_fault_warnings(0);
+        ref_mem.load_file(base + ".bin");
+        rv32i_hart h(ref_mem);
+        h.reset();
+        h.set_core(rv32i_hart::core_switch);
+        ostringstream want;
+        streambuf *old = cout.rdbuf(want.rdbuf());
+        h.run(limit);
+        h.dump();
+        cout << "Execution terminated. Reason: " << h.get_halt_reason() << endl;
+        cout << h.get_insn_counter() << " instructions executed" << endl;
+        cout.rdbuf(old);
+
+        ostringstream hex_size;
+        hex_size << std::hex << mem_size;
+        string run = base + " -m " + hex_size.str() + " -l " + to_string(limit) + " " + base + ".bin 2>/dev/null";
+        string got;
+        FILE *p = popen(run.c_str(), "r");
+        if(p != nullptr) {
+            char buf[4096];
+            size_t len;
+            while((len = fread(buf, 1, sizeof(buf), p)) != 0) {
+                got.append(buf, len);
+            }
+            if(pclose(p) != 0) {
+                got += "exited with an error\n";
+            }
+        }
+        if(got != want.str()) {
+            cout << what << ": aot with limit " << limit << " differs from tick()" << endl;
+            cout << "--- tick()" << endl << want.str() << "--- aot" << endl << got;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+/*************************************************************************
+Function: self_modifying
+
+Use: Makes a loop that adds to x2 with an addi whose immediate it bumps
+     each trip through a store into its own code, so the sum is only
+     right if the store is seen: 1 + 2 + ... + 10 = 55.
+
+Returns: vector<uint32_t>: The program.
+
+ ************************************************************************/
+static vector<uint32_t> self_modifying()
+{
+    vector<uint32_t> p;
+    p.push_back(enc_i(0x13, 2, 0, 0, 0));               // addi x2, x0, 0
+    p.push_back(enc_i(0x13, 3, 0, 0, 10));              // addi x3, x0, 10
+    p.push_back(enc_i(0x13, 2, 0, 2, 1));               // 8: addi x2, x2, 1
+    p.push_back(enc_i(0x03, 4, 2, 0, 8));               // lw x4, 8(x0)
+    p.push_back(0x001002b7);                            // lui x5, 0x100
+    p.push_back(enc_r(0, 5, 4, 0, 4));                  // add x4, x4, x5, the immediate + 1
+    p.push_back(enc_s(0, 4, 2, 8));                     // sw x4, 8(x0)
+    p.push_back(enc_i(0x13, 3, 0, 3, 0xfff));           // addi x3, x3, -1
+    p.push_back(enc_b(1, 3, 0, -6 * 4));                // bne x3, x0, 8
+    p.push_back(0x00100073);                            // ebreak
+    return p;
+}
+
+/*************************************************************************
+Function: load_image
+
+Use: Reads an image file the way main does, into a word vector.
+
+Arguments:
+1. const string &fname: The file.
+2. uint32_t mem_size: Bytes of guest memory.
+3. vector<uint32_t> &image: Where the words go.
+
+Returns: bool: false if the file cannot be loaded.
+
+ ************************************************************************/
+static bool load_image(const string &fname, uint32_t mem_size, vector<uint32_t> &image)
+{
+    memory mem(mem_size);
+    mem.set_fault_warnings(0);
+    if(!mem.load_file(fname)) {
+        return false;
+    }
+    image.resize(mem_size / 4);
+    return mem.read_block(0, image.data(), mem_size & ~3u);
+}
+
+/*************************************************************************
+Function: main
+
+Use: Checks the images named, then the random programs, and prints how
+     many of each agreed with the reference.
+
+Arguments:
+1. int argc: The number of arguments.
+2. char **argv: The arguments.
+
+Returns: int: 0 if every run agreed, 1 if any did not.
+
+ ************************************************************************/
+int main(int argc, char **argv)
+{
+    uint32_t mem_size = 0x1000;
+    uint64_t limit = 100000;
+    uint32_t seed = 1;
+    int cases = 500;
+    string aot_dir;
+    int opt;
+    while((opt = getopt(argc, argv, "m:l:s:n:a:")) != -1) {
+        istringstream iss(optarg ? optarg : "");
+        switch(opt) {
+            case 'm': iss >> std::hex >> mem_size; break;
+            case 'l': iss >> limit; break;
+            case 's': iss >> seed; break;
+            case 'n': iss >> cases; break;
+            case 'a': aot_dir = optarg; break;
+            default: usage();
+        }
+    }
+
+    rv32i_decode::set_isa(rv32i_decode::isa_all);
+
+    int bad = 0, total = 0;
+    if(check_store_faults() != 0) {
+        bad++;
+    }
+    total++;
+    mt19937 directed(seed);
+    if(check_unreset(random_loop(directed), 0x2000, 20000) != 0) {
+        bad++;
+    }
+    total++;
+
+    for(int i = optind; i < argc; i++) {
+        vector<uint32_t> image;
+        if(!load_image(argv[i], mem_size, image)) {
+            cerr << "Can't load " << argv[i] << endl;
+            return 1;
+        }
+        total++;
+        bad += !check(argv[i], image, mem_size, limit, seed + i);
+    }
+
+    mt19937 r(seed);
+    for(int i = 0; i < cases; i++) {
+        total++;
+        bad += !check("stream " + to_string(i), random_stream(r), 0x2000, 3000, r());
+    }
+    for(int i = 0; i < cases; i++) {
+        total++;
+        bad += !check("loop " + to_string(i), random_loop(r), 0x2000, 20000, r());
+    }
+
+    if(!aot_dir.empty()) {
+        string objs;
+        if(!aot_build_objects(aot_dir, objs)) {
+            return 1;
+        }
+        int n = 0;
+        for(int i = optind; i < argc; i++, n++) {
+            vector<uint32_t> image;
+            load_image(argv[i], mem_size, image);
+            total++;
+            bad += !check_aot(argv[i], image, mem_size, aot_dir, objs, n);
+        }
+        total++;
+        bad += !check_aot("self modifying", self_modifying(), 0x1000, aot_dir, objs, n++);
+        mt19937 ra(seed);
+        for(int i = 0; i < 4; i++) {
+            total++;
+            bad += !check_aot("aot stream " + to_string(i), random_stream(ra), 0x2000, aot_dir, objs, n++);
+            total++;
+            bad += !check_aot("aot loop " + to_string(i), random_loop(ra), 0x2000, aot_dir, objs, n++);
+        }
+    }
+
+    cout << total - bad << " of " << total << " programs agree on every core" << endl;
+    return bad != 0;
+}
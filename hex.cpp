@@ -9,13 +9,123 @@
 //*************************************************************************
 
 
-#include <iostream>
-#include <sstream>
 #include "hex.h"
-#include <iomanip>
 
 using namespace std;
 
+//nibble lookup table
+static const char hex_digits[] = "0123456789abcdef";
+
+/*************************************************************************
+Function: format_digits
+
+Use: writes the low digits of an integer as lower case hex
+
+Arguments: 1. buf: where to write, must have room for digits chars
+           2. uint32_t i: the integer we want to convert
+           3. digits: how many hex digits to write, zero padded
+
+Returns: one past the last character written
+
+ ************************************************************************/
+char *hex::format_digits(char *buf, uint32_t i, int digits)
+{
+    for(int d = digits - 1; d >= 0; d--)
+    {
+        buf[d] = hex_digits[i & 0xf];
+        i >>= 4;
+    }
+    return buf + digits;
+}
+
+/*************************************************************************
+Function: format_hex8
+
+Use: writes an 8 bit integer as 2 hex digits into buf
+
+Arguments: 1. buf: at least hex8_len chars
+           2. uint8_t i: the integer we want to convert
+
+Returns: one past the last character written
+
+ ************************************************************************/
+char *hex::format_hex8(char *buf, uint8_t i)
+{
+    buf[0] = hex_digits[i >> 4];
+    buf[1] = hex_digits[i & 0xf];
+    return buf + 2;
+}
+
+/*************************************************************************
+Function: format_hex32
+
+Use: writes a 32 bit integer as 8 hex digits into buf
+
+Arguments: 1. buf: at least hex32_len chars
+           2. uint32_t i: the integer we want to convert
+
+Returns: one past the last character written
+
+ ************************************************************************/
+char *hex::format_hex32(char *buf, uint32_t i)
+{
+    return format_digits(buf, i, 8);
+}
+
+/*************************************************************************
+Function: format_hex0x32
+
+Use: writes a 32 bit integer as 0x and 8 hex digits into buf
+
+Arguments: 1. buf: at least hex0x32_len chars
+           2. uint32_t i: the integer we want to convert
+
+Returns: one past the last character written
+
+ ************************************************************************/
+char *hex::format_hex0x32(char *buf, uint32_t i)
+{
+    buf[0] = '0';
+    buf[1] = 'x';
+    return format_digits(buf + 2, i, 8);
+}
+
+/*************************************************************************
+Function: format_hex0x20
+
+Use: writes the 20 LSB's of an integer as 0x and 5 hex digits into buf
+
+Arguments: 1. buf: at least hex0x20_len chars
+           2. uint32_t i: the integer we want to convert
+
+Returns: one past the last character written
+
+ ************************************************************************/
+char *hex::format_hex0x20(char *buf, uint32_t i)
+{
+    buf[0] = '0';
+    buf[1] = 'x';
+    return format_digits(buf + 2, i & 0xfffff, 5);
+}
+
+/*************************************************************************
+Function: format_hex0x12
+
+Use: writes the 12 LSB's of an integer as 0x and 3 hex digits into buf
+
+Arguments: 1. buf: at least hex0x12_len chars
+           2. uint32_t i: the integer we want to convert
+
+Returns: one past the last character written
+
+ ************************************************************************/
+char *hex::format_hex0x12(char *buf, uint32_t i)
+{
+    buf[0] = '0';
+    buf[1] = 'x';
+    return format_digits(buf + 2, i & 0xfff, 3);
+}
+
 /*************************************************************************
 Function: to_hex8
 
@@ -24,16 +134,13 @@ Use: convert an 8 bit integer to a 2 digit hex representation
 Arguments: 1. uint8_t i: the integer we want to convert
 
 Notes: Makes sure the string is 2 chars long
+    short enough for the small string buffer, so nothing is allocated
 
  ************************************************************************/
 string hex::to_hex8(uint8_t i)
 {
-    //
-    ostringstream os;
-    //have to use std:: since it'll grab the hex class instead
-    os << std::hex << setfill('0') << setw(2) << static_cast<uint16_t>(i);
-    return os.str();
-
+    char buf[hex8_len];
+    return string(buf, format_hex8(buf, i));
 } 
 
 /*************************************************************************
@@ -48,11 +155,8 @@ Notes: Makes sure the string is 8 char long
  ************************************************************************/
 string hex::to_hex32(uint32_t i)
 {
-    //
-    ostringstream os;
-    os << std::hex << setfill('0') << setw(8) << i;
-    return os.str();
-
+    char buf[hex32_len];
+    return string(buf, format_hex32(buf, i));
 } 
 
 /*************************************************************************
@@ -68,7 +172,8 @@ Notes: Makes sure the string is 8 char long
  ************************************************************************/
 string hex::to_hex0x32(uint32_t i)
 {
-    return string("0x") + to_hex32(i);
+    char buf[hex0x32_len];
+    return string(buf, format_hex0x32(buf, i));
 }
 
 /*************************************************************************
@@ -82,9 +187,8 @@ Arguments: 1. uint32_t i: the integer we want to convert
  ************************************************************************/
 string hex::to_hex0x20(uint32_t i)
 {
-    std::ostringstream oss;
-    oss << "0x" << setfill('0') << setw(5) << std::hex << (i & 0xfffff);
-    return oss.str();
+    char buf[hex0x20_len];
+    return string(buf, format_hex0x20(buf, i));
 }
 
 /*************************************************************************
@@ -98,8 +202,6 @@ Arguments: 1. uint32_t i: the integer we want to convert
  ************************************************************************/
 string hex::to_hex0x12(uint32_t i)
 {
-    ostringstream oss;
-    oss << "0x" << std::hex << setw(3) << setfill('0') << (i & 0x00000fff);
-    return oss.str();
+    char buf[hex0x12_len];
+    return string(buf, format_hex0x12(buf, i));
 }
-
@@ -25,6 +25,23 @@ public :
     static std :: string to_hex0x32 ( uint32_t i );
     static std :: string to_hex0x20(uint32_t i);
     static std :: string to_hex0x12(uint32_t i);
+
+    //allocation free forms, these write the digits into buf (no
+    //terminator) and return one past the last character written
+    static const int hex8_len = 2;
+    static const int hex32_len = 8;
+    static const int hex0x32_len = 10;
+    static const int hex0x20_len = 7;
+    static const int hex0x12_len = 5;
+
+    static char *format_hex8(char *buf, uint8_t i);
+    static char *format_hex32(char *buf, uint32_t i);
+    static char *format_hex0x32(char *buf, uint32_t i);
+    static char *format_hex0x20(char *buf, uint32_t i);
+    static char *format_hex0x12(char *buf, uint32_t i);
+
+private:
+    static char *format_digits(char *buf, uint32_t i, int digits);
 };
 
 #endif
\ No newline at end of file
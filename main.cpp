@@ -15,9 +15,13 @@
 #include <cstdlib>    
 #include <unistd.h>
 #include <string>   
+#include <fstream>
 #include "memory.h"   
 #include "hex.h"  
 #include "rv32i_decode.h"
+#include "rv32i_aot.h"
+#include "cpu_single_hart.h"
+#include "cpu_multi_hart.h"
 
 
 using namespace std;
@@ -26,12 +30,44 @@ static void usage();
 
 static void usage()
 {
-	cerr << "Usage: rv32i [-m hex-mem-size] infile" << endl;
+	cerr << "Usage: rv32i [-m hex-mem-size] [-a outfile] [-l exec-limit] [-c harts] [-q quantum] [-i extensions] infile" << endl;
 	cerr << "    -m specify memory size (default = 0x100)" << endl;
+	cerr << "    -a translate the image to C++ in outfile instead of disassembling it" << endl;
+	cerr << "    -l run the image after disassembling it, for at most exec-limit instructions (0 = no limit)" << endl;
+	cerr << "    -c run that many harts on the one memory, each on a host thread of its own (default = 1)" << endl;
+	cerr << "    -q take turns on one thread instead, quantum instructions at a time, for repeatable runs" << endl;
+	cerr << "    -i also decode the comma separated extensions, from zba and zbb" << endl;
 	exit(1);
 }
 
 
+/*************************************************************************
+Function: parse_isa
+
+Use: Turns a comma separated list of extension names into isa_ext bits
+
+Arguments: 1. list: the names, like "zba,zbb"
+		   2. &isa: where the bits go
+
+Returns: false if a name is not one the decoder knows
+ ************************************************************************/
+static bool parse_isa(const string &list, uint32_t &isa)
+{
+	isa = rv32i_decode::isa_base;
+	std::istringstream iss(list);
+	string name;
+	while (getline(iss, name, ','))
+	{
+		if (name == "zba")
+			isa |= rv32i_decode::isa_zba;
+		else if (name == "zbb")
+			isa |= rv32i_decode::isa_zbb;
+		else
+			return false;
+	}
+	return true;
+}
+
 /*************************************************************************
 Function: disassemble
 
@@ -44,7 +80,7 @@ Returns: void
  ************************************************************************/
 static void disassemble(const memory &mem)
 {
-    for (uint32_t addr = 0; addr < mem.get_size(); addr += 4)
+    for (uint64_t addr = 0; addr < mem.get_size(); addr += 4)
     {
         uint32_t insn = mem.get32(addr);
         string decoded = rv32i_decode::decode(addr, insn);
@@ -64,8 +100,14 @@ Returns: 0 if it's successful
 int main(int argc, char **argv)
 {
 	uint32_t memory_limit = 0x100; // default memory size = 256 bytes
+	string aot_file;
+	bool simulate = false;
+	uint32_t exec_limit = 0;
+	uint32_t hart_count = 1;
+	uint64_t quantum = 0;
+	uint32_t isa = rv32i_decode::isa_base;
 	int opt;
-	while ((opt = getopt(argc, argv, "m:")) != -1)
+	while ((opt = getopt(argc, argv, "m:a:l:c:q:i:")) != -1)
 	{
 		switch (opt)
 		{
@@ -75,6 +117,32 @@ int main(int argc, char **argv)
 				iss >> std::hex >> memory_limit;
 			}
 			break;
+			case 'a':
+				aot_file = optarg;
+				break;
+			case 'l':
+			{
+				std::istringstream iss(optarg);
+				iss >> exec_limit;
+				simulate = true;
+			}
+			break;
+			case 'c':
+			{
+				std::istringstream iss(optarg);
+				iss >> hart_count;
+			}
+			break;
+			case 'q':
+			{
+				std::istringstream iss(optarg);
+				iss >> quantum;
+			}
+			break;
+			case 'i':
+				if (!parse_isa(optarg, isa))
+					usage();
+				break;
 		default: /* ’?’ */
 			usage();
 		}
@@ -82,14 +150,56 @@ int main(int argc, char **argv)
 	if (optind >= argc)
 		usage(); // missing filename
 
+	rv32i_decode::set_isa(isa);
+
 	memory mem(memory_limit);
 
-	if (!mem.load_file(argv[optind]))
+	// ELF images carry their own layout, anything else is a flat binary at 0
+	bool loaded;
+	uint32_t entry = 0;
+	if (memory::is_elf(argv[optind]))
+	{
+		loaded = mem.load_elf(argv[optind], entry);
+	}
+	else
+	{
+		loaded = mem.load_file(argv[optind]);
+	}
+	if (!loaded)
 		usage();
 
+	if (!aot_file.empty())
+	{
+		ofstream out(aot_file);
+		if (!out || !rv32i_aot::translate(mem, entry, out))
+		{
+			cerr << "Can't translate " << argv[optind] << " to " << aot_file << endl;
+			return 1;
+		}
+		return 0;
+	}
 
 	disassemble(mem);
 	mem.dump();
 
+	if (simulate && hart_count <= 1)
+	{
+		cpu_single_hart cpu(mem, exec_limit);
+		cpu.get_hart().set_pc(entry);
+		cpu.run();
+	}
+	else if (simulate)
+	{
+		cpu_multi_hart cpu(mem, hart_count, exec_limit);
+		for (uint32_t i = 0; i < hart_count; i++)
+			cpu.get_hart(i).set_pc(entry);
+		if (quantum != 0)
+		{
+			cpu.set_schedule(cpu_multi_hart::sched_round_robin);
+			cpu.set_quantum(quantum);
+		}
+		cpu.run();
+	}
+
 	return 0;
 }
\ No newline at end of file
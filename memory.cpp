@@ -12,27 +12,76 @@
 
 #include "memory.h"
 #include <iostream>
-#include <fstream>
 #include <iomanip>
 #include <cctype>
+#include <cstring>
+#include <cstdlib>
+#include <new>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace std;
 
+// guest memory is little-endian; only swap when the host is not
+static inline uint16_t from_le16(uint16_t v)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return __builtin_bswap16(v);
+#else
+    return v;
+#endif
+}
+
+static inline uint32_t from_le32(uint32_t v)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return __builtin_bswap32(v);
+#else
+    return v;
+#endif
+}
+
 /*************************************************************************
 Function: memory
 
 Use: constructs an object of the memory class
 
-Arguments: uint32_t s: a 32 bit integer to build the memory with
+Arguments: 1. s: a 32 bit integer to build the memory with
+           2. mode: paged (default) or guarded host backing
 
 Notes: base constructor
+    only the page table is allocated here, pages come in on first write
+    so a high stack does not cost a host allocation of the whole range
+    if the guarded reservation can not be made we stay paged
 
  ************************************************************************/
-memory::memory(uint32_t s)
+memory::memory(uint32_t s, backing_mode mode)
 {
-    // Round up the size to closest mult of 16
-    s = (s + 15) & 0xFFFFFFF0;
-    mem.resize(s, 0xA5);
+    // Round up the size to closest mult of 16, 64 bits so 0xffffffff
+    // rounds to the full 4 GiB instead of wrapping
+    size = (static_cast<uint64_t>(s) + 15) & ~static_cast<uint64_t>(15);
+
+    // calloc hands back fresh zero pages for a big table, so even the
+    // page tables cost nothing until they are written
+    page_count = (size + page_mask) >> page_bits;
+    code_lines = static_cast<std::atomic<uint8_t> *>(calloc((size >> code_line_bits) + 1, sizeof(std::atomic<uint8_t>)));
+    if(code_lines == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    if(mode == backing_guarded && map_guarded())
+    {
+        return;
+    }
+    pages = static_cast<std::atomic<uint8_t *> *>(calloc(page_count, sizeof(std::atomic<uint8_t *>)));
+    if(pages == nullptr)
+    {
+        throw std::bad_alloc();
+    }
 }
 
 /*************************************************************************
@@ -47,19 +96,400 @@ Notes: base destructor
  ************************************************************************/
 memory::~memory()
 {
- 
+    unmap_guarded();
+    if(pages != nullptr)
+    {
+        for(uint64_t i = 0; i < page_count; i++)
+        {
+            delete[] pages[i].load();
+        }
+        free(pages);
+    }
+    free(code_lines);
+}
+
+//guarded memories the fault handler knows about
+static const int max_guarded = 16;
+static memory *guarded[max_guarded];
+static struct sigaction prev_segv;
+static struct sigaction prev_bus;
+
+//held by the fault handler while it maps in a page, harts on two threads
+//can touch the same new page at once
+static std::atomic_flag guard_touch_lock = ATOMIC_FLAG_INIT;
+
+thread_local sigjmp_buf *memory::guard_env = nullptr;
+thread_local uint32_t memory::guard_fault_addr = 0;
+thread_local bool memory::guard_fault_write = false;
+
+thread_local memory::fault memory::last_fault = {};
+thread_local const memory *memory::fault_owner = nullptr;
+
+/*************************************************************************
+Function: map_guarded
+
+Use: reserves the whole 32-bit guest address space plus a trailing guard
+page as PROT_NONE host memory
+
+Arguments: none
+
+Returns: true if guarded mode is active
+
+Notes: guest pages are replaced by writable pages filled with 0xA5 by
+the fault handler the first time they are touched. Everything from size
+up is left PROT_NONE so a bad guest address faults on the host instead of being
+range checked in every accessor.
+
+ ************************************************************************/
+bool memory::map_guarded()
+{
+    // first touches need mremap(MREMAP_FIXED), which only Linux has
+#if UINTPTR_MAX > 0xffffffffu && defined(__linux__)
+    int slot = 0;
+    while(slot < max_guarded && guarded[slot] != nullptr)
+    {
+        slot++;
+    }
+    if(slot == max_guarded)
+    {
+        return false;
+    }
+
+    // pad the front so the end of guest memory falls on a page boundary,
+    // otherwise the tail of a partial last page would be silently usable
+    size_t pad = (page_size - (size & page_mask)) & page_mask;
+    guard_length = pad + (static_cast<size_t>(1) << 32) + page_size;
+    void *p = mmap(nullptr, guard_length, PROT_NONE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if(p == MAP_FAILED)
+    {
+        guard_length = 0;
+        return false;
+    }
+    guard_touched = static_cast<uint8_t *>(calloc(guard_length >> page_bits, 1));
+    if(guard_touched == nullptr)
+    {
+        munmap(p, guard_length);
+        guard_length = 0;
+        return false;
+    }
+    guard_region = static_cast<uint8_t *>(p);
+    guard_base = guard_region + pad;
+
+    bool first = true;
+    for(int i = 0; i < max_guarded; i++)
+    {
+        if(guarded[i] != nullptr)
+        {
+            first = false;
+        }
+    }
+    guarded[slot] = this;
+    if(first)
+    {
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_sigaction = guard_fault_handler;
+        sigemptyset(&sa.sa_mask);
+        // NODEFER so a siglongjmp out of the handler leaves SIGSEGV unblocked
+        sa.sa_flags = SA_SIGINFO | SA_NODEFER;
+        sigaction(SIGSEGV, &sa, &prev_segv);
+        sigaction(SIGBUS, &sa, &prev_bus);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*************************************************************************
+Function: unmap_guarded
+
+Use: releases the guarded reservation and the fault handler with it
+
+Arguments: none
+
+ ************************************************************************/
+void memory::unmap_guarded()
+{
+    if(guard_region == nullptr)
+    {
+        return;
+    }
+
+    bool last = true;
+    for(int i = 0; i < max_guarded; i++)
+    {
+        if(guarded[i] == this)
+        {
+            guarded[i] = nullptr;
+        }
+        else if(guarded[i] != nullptr)
+        {
+            last = false;
+        }
+    }
+    if(last)
+    {
+        sigaction(SIGSEGV, &prev_segv, nullptr);
+        sigaction(SIGBUS, &prev_bus, nullptr);
+    }
+    munmap(guard_region, guard_length);
+    free(guard_touched);
+    guard_region = nullptr;
+    guard_base = nullptr;
+    guard_touched = nullptr;
+}
+
+/*************************************************************************
+Function: guard_fault_handler
+
+Use: SIGSEGV/SIGBUS handler for guarded memories
+
+Arguments: 1. sig: the signal number
+           2. info: the fault details, si_addr is the host address
+           3. uctx: the interrupted context, used to tell reads from writes
+
+Notes: a fault below guard_base + size is a first touch, so the page is
+mapped in and the access retried. A fault above it is a guest access
+fault and unwinds to the active guarded_call. Anything else is handed
+back to the previous disposition.
+    first touches are serialized, and a thread that faulted on a page
+another one has filled in the meantime just retries, so the second fill
+can not wipe out what the first thread stored. The filled page replaces
+the PROT_NONE one in a single mremap, so it is never reachable half
+filled.
+
+ ************************************************************************/
+void memory::guard_fault_handler(int sig, siginfo_t *info, void *uctx)
+{
+    uint8_t *a = static_cast<uint8_t *>(info->si_addr);
+    for(int i = 0; i < max_guarded; i++)
+    {
+        memory *m = guarded[i];
+        if(m == nullptr || a < m->guard_region || a >= m->guard_region + m->guard_length)
+        {
+            continue;
+        }
+
+        if(a < m->guard_base + m->size)
+        {
+            uintptr_t pg = reinterpret_cast<uintptr_t>(a) & ~static_cast<uintptr_t>(page_mask);
+            void *p = reinterpret_cast<void *>(pg);
+            uint8_t &touched = m->guard_touched[(a - m->guard_region) >> page_bits];
+            while(guard_touch_lock.test_and_set(std::memory_order_acquire))
+            {
+            }
+            if(!touched)
+            {
+                // fill a page of its own, then swap it in whole, so no
+                // thread can store to the page before it holds the fill
+                void *fill = mmap(nullptr, page_size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if(fill != MAP_FAILED)
+                {
+                    memset(fill, 0xA5, page_size);
+                    if(mremap(fill, page_size, page_size, MREMAP_MAYMOVE | MREMAP_FIXED, p) != MAP_FAILED)
+                    {
+                        touched = 1;
+                    }
+                    else
+                    {
+                        munmap(fill, page_size);
+                    }
+                }
+            }
+            bool mapped = touched;
+            guard_touch_lock.clear(std::memory_order_release);
+            if(mapped)
+            {
+                return;
+            }
+        }
+        else if(guard_env != nullptr)
+        {
+            guard_fault_addr = static_cast<uint32_t>(a - m->guard_base);
+#if defined(__linux__) && defined(__x86_64__)
+            // bit 1 of the page fault error code is set for writes
+            const ucontext_t *uc = static_cast<const ucontext_t *>(uctx);
+            guard_fault_write = (uc->uc_mcontext.gregs[REG_ERR] & 2) != 0;
+#else
+            guard_fault_write = false;
+#endif
+            siglongjmp(*guard_env, 1);
+        }
+        break;
+    }
+
+    // not a guest access we can recover, let the old handler have it
+    sigaction(sig, sig == SIGBUS ? &prev_bus : &prev_segv, nullptr);
+}
+
+/*************************************************************************
+Function: record_guard_fault
+
+Use: records the fault that just ended a guarded_call on this thread
+
+Arguments: none
+
+Returns: nothing
+
+Notes: the host fault does not say how wide the access was, so the
+width is recorded as 0. Reads and writes are told apart on x86-64 Linux,
+elsewhere every fault is recorded as a read.
+
+ ************************************************************************/
+void memory::record_guard_fault() const
+{
+    record_fault(guard_fault_addr, 0, guard_fault_write ? fault_write : fault_read);
+}
+
+/*************************************************************************
+Function: get_guard_fault_addr
+
+Use: reports the guest address of the last fault that ended a
+guarded_call on this thread
+
+Arguments: none
+
+Returns: the faulting guest address
+
+ ************************************************************************/
+uint32_t memory::get_guard_fault_addr()
+{
+    return guard_fault_addr;
 }
 
-bool memory::check_illegal(uint32_t addr) const
+/*************************************************************************
+Function: check_illegal
+
+Use: checks that an access of len bytes at addr is inside guest memory
+
+Arguments: 1. addr: the first guest address of the access
+           2. len: how many bytes are accessed (default 1)
+           3. kind: what the access was for (default read)
+
+Returns: true and records a fault if any byte is out of range
+
+ ************************************************************************/
+bool memory::check_illegal(uint32_t addr, uint32_t len, fault_kind kind) const
 {
-    if(addr >= mem.size())
+    if(static_cast<uint64_t>(addr) + len > size)
     {
-        cerr << "WARNING: Address out of range: " << hex::to_hex0x32(addr) << endl;
+        record_fault(addr, len, kind);
         return true;
     }
     return false;
 }
 
+/*************************************************************************
+Function: record_fault
+
+Use: notes an out of range access so the hart can trap or halt on it
+
+Arguments: 1. addr: the first guest address of the access
+           2. width: the access size in bytes, 0 if the host could not tell
+           3. kind: read, write or fetch
+
+Returns: nothing
+
+Notes: the warning is only printed for the first warning_limit faults,
+a guest stuck in a bad loop would otherwise spend all of its time in
+unbuffered cerr writes
+
+ ************************************************************************/
+void memory::record_fault(uint32_t addr, uint32_t width, fault_kind kind) const
+{
+    last_fault.addr = addr;
+    last_fault.width = width;
+    last_fault.kind = kind;
+    last_fault.pc = 0;
+    fault_owner = this;
+    fault_counts[kind]++;
+
+    if(warnings_printed.load(std::memory_order_relaxed) < warning_limit)
+    {
+        uint32_t n = warnings_printed++;
+        if(n < warning_limit)
+        {
+            cerr << "WARNING: Address out of range: " << hex::to_hex0x32(addr) << endl;
+            if(n + 1 == warning_limit)
+            {
+                cerr << "WARNING: further address warnings suppressed" << endl;
+            }
+        }
+    }
+}
+
+/*************************************************************************
+Function: take_fault
+
+Use: hands the most recent unconsumed fault to the caller
+
+Arguments: 1. f: set to the fault if there is one
+
+Returns: true if a fault was pending, which it no longer is
+
+ ************************************************************************/
+bool memory::take_fault(fault &f)
+{
+    if(fault_owner != this)
+    {
+        return false;
+    }
+    f = last_fault;
+    fault_owner = nullptr;
+    return true;
+}
+
+/*************************************************************************
+Function: get_fault_count
+
+Use: reports how many out of range accesses of one kind were seen
+
+Arguments: 1. kind: read, write or fetch
+
+Returns: the count since construction
+
+ ************************************************************************/
+uint64_t memory::get_fault_count(fault_kind kind) const
+{
+    return fault_counts[kind];
+}
+
+/*************************************************************************
+Function: get_fault_count
+
+Use: reports how many out of range accesses were seen in total
+
+Arguments: none
+
+Returns: the count since construction
+
+ ************************************************************************/
+uint64_t memory::get_fault_count() const
+{
+    return fault_counts[fault_read] + fault_counts[fault_write] + fault_counts[fault_fetch];
+}
+
+/*************************************************************************
+Function: set_fault_warnings
+
+Use: sets how many out of range warnings get printed
+
+Arguments: 1. limit: the number of warnings to print, 0 for none
+
+Returns: nothing
+
+Notes: faults are recorded and counted either way
+
+ ************************************************************************/
+void memory::set_fault_warnings(uint32_t limit)
+{
+    warning_limit = limit;
+    warnings_printed = 0;
+}
+
 /*************************************************************************
 Function: get_size()
 
@@ -67,15 +497,90 @@ Use: Gets the size of the memory
 
 Arguments: none
 
-Returns uint32_t size
+Returns uint64_t size
 
 Notes: lets other functions use the size 
+    64 bits wide since a full address space is 0x100000000 bytes
+
+ ************************************************************************/
+uint64_t memory::get_size() const
+{
+    return size;
+}
+
+//what every untouched page reads as
+static struct fill_page_t
+{
+    uint8_t bytes[memory::page_size];
+    fill_page_t() { memset(bytes, 0xA5, sizeof(bytes)); }
+} fill_page;
+
+/*************************************************************************
+Function: read_page
+
+Use: finds the host page to read a guest address from
+
+Arguments: 1. addr: a guest address that has passed check_illegal
+
+Returns: pointer to the start of the 4 KiB page holding addr
+
+Notes: an untouched page is served from the shared 0xA5 fill page, so
+reads never allocate
+
+ ************************************************************************/
+const uint8_t *memory::read_page(uint32_t addr) const
+{
+    const uint8_t *p = pages[addr >> page_bits].load(std::memory_order_acquire);
+    return p != nullptr ? p : fill_page.bytes;
+}
+
+/*************************************************************************
+Function: page
+
+Use: finds the host page to write a guest address to
+
+Arguments: 1. addr: a guest address that has passed check_illegal
+
+Returns: pointer to the start of the 4 KiB page holding addr
+
+Notes: the page is allocated the first time it is written
 
  ************************************************************************/
-uint32_t memory::get_size() const
+uint8_t *memory::page(uint32_t addr)
 {
-    //return size of the vector
-    return mem.size();
+    uint8_t *p = pages[addr >> page_bits].load(std::memory_order_acquire);
+    if(p == nullptr)
+    {
+        p = alloc_page(addr);
+    }
+    return p;
+}
+
+/*************************************************************************
+Function: alloc_page
+
+Use: allocates the page holding addr and fills it with 0xA5
+
+Arguments: 1. addr: a guest address inside the page
+
+Returns: pointer to the new page
+
+Notes: another thread may have allocated it since the caller looked, in
+which case that page is returned
+
+ ************************************************************************/
+uint8_t *memory::alloc_page(uint32_t addr)
+{
+    std::lock_guard<std::mutex> lock(page_lock);
+    std::atomic<uint8_t *> &slot = pages[addr >> page_bits];
+    uint8_t *p = slot.load(std::memory_order_relaxed);
+    if(p == nullptr)
+    {
+        p = new uint8_t[page_size];
+        memcpy(p, fill_page.bytes, page_size);
+        slot.store(p, std::memory_order_release);
+    }
+    return p;
 }
 
 /*************************************************************************
@@ -92,13 +597,17 @@ Notes: Does not change anything in memory
  ************************************************************************/
 uint8_t memory::get8(uint32_t addr) const
 {
-    
+    if(guard_base)
+    {
+        return guard_base[addr];
+    }
+
     if(check_illegal(addr) == true)
     {
         return 0;
     }
     //return memory at the address
-    return mem[addr];
+    return read_page(addr)[addr & page_mask];
 }
 
 /*************************************************************************
@@ -115,9 +624,29 @@ Notes: Does not change anything in memory
  ************************************************************************/
 uint16_t memory::get16(uint32_t addr) const
 {
-    uint16_t lower = get8(addr);
-    uint16_t upper = get8(addr + 1);
-    return lower | (upper << 8);
+    if(guard_base)
+    {
+        uint16_t val;
+        memcpy(&val, guard_base + addr, sizeof(val));
+        return from_le16(val);
+    }
+
+    // size is a multiple of 16, so an aligned addr below it has room for both bytes
+    if((addr & 1) == 0 && addr < size)
+    {
+        uint16_t val;
+        memcpy(&val, read_page(addr) + (addr & page_mask), sizeof(val));
+        return from_le16(val);
+    }
+
+    // misaligned or out of range, one check for the whole access then bytes
+    if(check_illegal(addr, 2))
+    {
+        return 0;
+    }
+    uint8_t b[2];
+    copy_out(addr, b, sizeof(b));
+    return b[0] | (b[1] << 8);
 }
 
 /*************************************************************************
@@ -130,14 +659,32 @@ Arguments: 1. addr: the memory address we want to get the integer from
 Returns: the byte value at addr and addr+ 2
 
 Notes: Does not change anything in memory
+    aligned reads take a single range check and one host load
 
  ************************************************************************/
 uint32_t memory::get32(uint32_t addr) const
 {
+    if(guard_base)
+    {
+        uint32_t val;
+        memcpy(&val, guard_base + addr, sizeof(val));
+        return from_le32(val);
+    }
+
+    if((addr & 3) == 0 && addr < size)
+    {
+        uint32_t val;
+        memcpy(&val, read_page(addr) + (addr & page_mask), sizeof(val));
+        return from_le32(val);
+    }
 
-    uint32_t lower = get16(addr);
-    uint32_t upper = get16(addr + 2);
-    return lower | (upper << 16);
+    if(check_illegal(addr, 4))
+    {
+        return 0;
+    }
+    uint8_t b[4];
+    copy_out(addr, b, sizeof(b));
+    return b[0] | (b[1] << 8) | (b[2] << 16) | (static_cast<uint32_t>(b[3]) << 24);
 }
 
 /*************************************************************************
@@ -214,17 +761,24 @@ Notes: Does not work if memory is illegal
  ************************************************************************/
 void memory::set8(uint32_t addr, uint8_t val)
 {
-    if (check_illegal(addr))
+    if(guard_base)
+    {
+        guard_base[addr] = val;
+        note_write(addr, 1);
+        return;
+    }
+    if (check_illegal(addr, 1, fault_write))
     {
         return; 
     }
-    mem[addr] = val;
+    page(addr)[addr & page_mask] = val;
+    note_write(addr, 1);
 }
 
 /*************************************************************************
 Function: set16
 
-Use: Calls set8 twice to account for a 16 bit value to set in memory
+Use: sets a 16 bit value in memory
 
 Arguments: 1. addr: the memory address we want to get the integer from
            2. val: the value we want to set
@@ -236,14 +790,34 @@ Notes: Inputs a 16 bit value into memory
  ************************************************************************/
 void memory::set16(uint32_t addr, uint16_t val)
 {
-    set8(addr, static_cast<uint8_t>(val & 0xFF));
-    set8(addr + 1, static_cast<uint8_t>((val >> 8) & 0xFF));
+    if(guard_base)
+    {
+        uint16_t le = from_le16(val);
+        memcpy(guard_base + addr, &le, sizeof(le));
+        note_write(addr, sizeof(le));
+        return;
+    }
+
+    if((addr & 1) == 0 && addr < size)
+    {
+        uint16_t le = from_le16(val);
+        memcpy(page(addr) + (addr & page_mask), &le, sizeof(le));
+        note_write(addr, sizeof(le));
+        return;
+    }
+
+    if(check_illegal(addr, 2, fault_write))
+    {
+        return;
+    }
+    uint8_t b[2] = { static_cast<uint8_t>(val & 0xFF), static_cast<uint8_t>((val >> 8) & 0xFF) };
+    copy_in(addr, b, sizeof(b));
 }
 
 /*************************************************************************
 Function: set32
 
-Use: Calls set16 twice to account for a 32 bit value to set in memory
+Use: sets a 32 bit value in memory
 
 Arguments: 1. addr: the memory address we want to get the integer from
            2. val: the value we want to set
@@ -251,18 +825,277 @@ Arguments: 1. addr: the memory address we want to get the integer from
 Returns: nothing
 
 Notes: sets a 32 bit value into memory
-    set8 eventually gets called from set16, which uses check_illegal
+    aligned writes take a single range check and one host store, anything
+    else is checked once as a whole and then written a byte at a time
 
  ************************************************************************/
 void memory::set32(uint32_t addr, uint32_t val)
 {
-    //lower bits
-    set16(addr, static_cast<uint16_t>(val & 0xFFFF));
-    
-    //upper bits
-    set16(addr + 2, static_cast<uint16_t>((val >> 16) & 0xFFFF));
-}
-
+    if(guard_base)
+    {
+        uint32_t le = from_le32(val);
+        memcpy(guard_base + addr, &le, sizeof(le));
+        note_write(addr, sizeof(le));
+        return;
+    }
+
+    if((addr & 3) == 0 && addr < size)
+    {
+        uint32_t le = from_le32(val);
+        memcpy(page(addr) + (addr & page_mask), &le, sizeof(le));
+        note_write(addr, sizeof(le));
+        return;
+    }
+
+    if(check_illegal(addr, 4, fault_write))
+    {
+        return;
+    }
+    uint8_t b[4] = { static_cast<uint8_t>(val & 0xFF), static_cast<uint8_t>((val >> 8) & 0xFF),
+        static_cast<uint8_t>((val >> 16) & 0xFF), static_cast<uint8_t>((val >> 24) & 0xFF) };
+    copy_in(addr, b, sizeof(b));
+}
+
+/*************************************************************************
+Function: atomic_word
+
+Use: finds the host word an atomic access to a guest address works on
+
+Arguments: 1. addr: a word aligned guest address
+
+Returns: pointer to the word, or nullptr if addr is out of range, in
+which case the fault has been recorded
+
+Notes: in guarded mode an out of range address faults when the word is
+used instead
+
+ ************************************************************************/
+uint32_t *memory::atomic_word(uint32_t addr)
+{
+    if(guard_base)
+    {
+        return reinterpret_cast<uint32_t *>(guard_base + addr);
+    }
+    if(check_illegal(addr, 4, fault_write))
+    {
+        return nullptr;
+    }
+    return reinterpret_cast<uint32_t *>(page(addr) + (addr & page_mask));
+}
+
+/*************************************************************************
+Function: get32_atomic
+
+Use: reads an aligned word as one host atomic load, for lr.w
+
+Arguments: 1. addr: a word aligned guest address
+
+Returns: the word, 0 if addr is out of range
+
+ ************************************************************************/
+uint32_t memory::get32_atomic(uint32_t addr) const
+{
+    const uint32_t *w;
+    if(guard_base)
+    {
+        w = reinterpret_cast<const uint32_t *>(guard_base + addr);
+    }
+    else
+    {
+        if(check_illegal(addr, 4))
+        {
+            return 0;
+        }
+        w = reinterpret_cast<const uint32_t *>(read_page(addr) + (addr & page_mask));
+    }
+    return from_le32(__atomic_load_n(w, __ATOMIC_SEQ_CST));
+}
+
+/*************************************************************************
+Function: amo32
+
+Use: atomically applies an operation to a word, the way the A extension
+AMOs do
+
+Arguments: 1. addr: a word aligned guest address
+           2. op: what to do to the word
+           3. val: the other operand
+
+Returns: the word as it was before, 0 if addr is out of range
+
+Notes: harts on other threads see all of the update or none of it.
+swap and the bitwise ops are single host atomics, as is add on a little
+endian host, the rest are a compare and swap loop
+
+ ************************************************************************/
+uint32_t memory::amo32(uint32_t addr, amo_op op, uint32_t val)
+{
+    uint32_t *w = atomic_word(addr);
+    if(w == nullptr)
+    {
+        return 0;
+    }
+
+    uint32_t old;
+    switch(op)
+    {
+        case amo_swap:
+            old = __atomic_exchange_n(w, from_le32(val), __ATOMIC_SEQ_CST);
+            break;
+        case amo_xor:
+            old = __atomic_fetch_xor(w, from_le32(val), __ATOMIC_SEQ_CST);
+            break;
+        case amo_and:
+            old = __atomic_fetch_and(w, from_le32(val), __ATOMIC_SEQ_CST);
+            break;
+        case amo_or:
+            old = __atomic_fetch_or(w, from_le32(val), __ATOMIC_SEQ_CST);
+            break;
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_BIG_ENDIAN__
+        case amo_add:
+            old = __atomic_fetch_add(w, val, __ATOMIC_SEQ_CST);
+            break;
+#endif
+        default:
+        {
+            old = __atomic_load_n(w, __ATOMIC_RELAXED);
+            uint32_t want;
+            do
+            {
+                uint32_t cur = from_le32(old);
+                uint32_t res;
+                switch(op)
+                {
+                    case amo_add:  res = cur + val; break;
+                    case amo_min:  res = static_cast<int32_t>(cur) < static_cast<int32_t>(val) ? cur : val; break;
+                    case amo_max:  res = static_cast<int32_t>(cur) > static_cast<int32_t>(val) ? cur : val; break;
+                    case amo_minu: res = cur < val ? cur : val; break;
+                    default:       res = cur > val ? cur : val; break;
+                }
+                want = from_le32(res);
+            } while(!__atomic_compare_exchange_n(w, &old, want, true, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED));
+            break;
+        }
+    }
+    note_write(addr, 4);
+    return from_le32(old);
+}
+
+/*************************************************************************
+Function: cmpxchg32
+
+Use: atomically replaces a word if it still holds the value expected
+
+Arguments: 1. addr: a word aligned guest address
+           2. expected: what the word has to hold
+           3. val: what to put there
+
+Returns: true if the word was replaced, false if it held something else
+or addr is out of range
+
+ ************************************************************************/
+bool memory::cmpxchg32(uint32_t addr, uint32_t expected, uint32_t val)
+{
+    uint32_t *w = atomic_word(addr);
+    if(w == nullptr)
+    {
+        return false;
+    }
+    uint32_t old = from_le32(expected);
+    if(!__atomic_compare_exchange_n(w, &old, from_le32(val), false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+    {
+        return false;
+    }
+    note_write(addr, 4);
+    return true;
+}
+
+/*************************************************************************
+Function: read_block
+
+Use: copies a block of guest memory out to a host buffer
+
+Arguments: 1. addr: the first guest address to read
+           2. dst: where to put the bytes
+           3. len: how many bytes to copy
+
+Returns: true on success, false (and nothing copied) if any byte of the
+block is out of range
+
+Notes: the range is checked once for the whole block. These block
+calls are made by the host, so a bad range is not recorded as a guest
+fault for take_fault() to find, the same goes for write_block and fill
+
+ ************************************************************************/
+bool memory::read_block(uint32_t addr, void *dst, uint32_t len) const
+{
+    if(!in_range(addr, len))
+    {
+        return false;
+    }
+    copy_out(addr, static_cast<uint8_t *>(dst), len);
+    return true;
+}
+
+/*************************************************************************
+Function: write_block
+
+Use: copies a host buffer into guest memory
+
+Arguments: 1. addr: the first guest address to write
+           2. src: the bytes to copy
+           3. len: how many bytes to copy
+
+Returns: true on success, false (and nothing written) if any byte of the
+block is out of range
+
+ ************************************************************************/
+bool memory::write_block(uint32_t addr, const void *src, uint32_t len)
+{
+    if(!in_range(addr, len))
+    {
+        return false;
+    }
+    copy_in(addr, static_cast<const uint8_t *>(src), len);
+    return true;
+}
+
+/*************************************************************************
+Function: fill
+
+Use: sets a block of guest memory to one byte value
+
+Arguments: 1. addr: the first guest address to write
+           2. val: the byte to store
+           3. len: how many bytes to set
+
+Returns: true on success, false (and nothing written) if any byte of the
+block is out of range
+
+ ************************************************************************/
+bool memory::fill(uint32_t addr, uint8_t val, uint32_t len)
+{
+    if(!in_range(addr, len))
+    {
+        return false;
+    }
+    fill_in(addr, val, len);
+    return true;
+}
+
+//lookup table for the printable column of dump
+static struct dump_text_t
+{
+    char text[256];
+    dump_text_t()
+    {
+        for(int i = 0; i < 256; i++)
+        {
+            text[i] = isprint(i) ? static_cast<char>(i) : '.';
+        }
+    }
+} dump_text;
+
 /*************************************************************************
 Function: dump
 
@@ -273,59 +1106,311 @@ Arguments: none
 
 Returns: nothing
 
-Notes: each line prints 16 bytes
+Notes: each line prints 16 bytes, every line is printed
 
  ************************************************************************/
 void memory::dump() const
+{
+    dump(0, size, false);
+}
+
+/*************************************************************************
+Function: dump
+
+Use: Prints out a range of the memory
+
+Arguments: 1. first: the first address to print, rounded down to 16
+           2. len: how many bytes to print, clipped to the end of memory
+           3. squeeze: print a line of * in place of repeated lines
+
+Returns: nothing
+
+Notes: lines are formatted with the hex buffer forms and a lookup
+table for the text column into one large buffer
+that is written out in big chunks. With squeeze on, a run of lines that
+match the one before it collapses to a single * the way hexdump does, and
+the last line of the range is always printed so its end is visible.
+
+ ************************************************************************/
+void memory::dump(uint32_t first, uint64_t len, bool squeeze) const
 {
     const size_t line_bytes = 16;
-    for(size_t i = 0; i < mem.size(); i+= line_bytes)
+    const size_t line_chars = 10 + line_bytes * 3 + 1 + line_bytes + 1;
+    const size_t buf_lines = 4096;
+
+    uint64_t start = first & ~static_cast<uint64_t>(line_bytes - 1);
+    uint64_t end = static_cast<uint64_t>(first) + len;
+    if(end > size)
     {
+        end = size;
+    }
 
+    char *buf = new char[buf_lines * line_chars];
+    char *out = buf;
+    uint8_t line[line_bytes];
+    uint8_t prev[line_bytes];
+    bool have_prev = false;
+    bool starred = false;
 
-            //address
-        cout << hex::to_hex32(static_cast<uint32_t>(i)) << ": ";
-        
-            //bytes in hex
-        for(size_t b = 0; b < line_bytes; b++)
+    for(uint64_t i = start; i < end; i += line_bytes)
+    {
+        // size is a multiple of 16 so every line is whole
+        copy_out(i, line, line_bytes);
+
+        bool last = i + line_bytes >= end;
+        if(squeeze && have_prev && !last && memcmp(line, prev, line_bytes) == 0)
         {
-            if(i + b < mem.size())
-            {
-                cout << hex::to_hex8(mem[i + b]) << " ";
-            }
-            else
+            if(!starred)
             {
-                //some spaces to make the dump formatted
-                cout << "   ";
+                *out++ = '*';
+                *out++ = '\n';
+                starred = true;
             }
+            continue;
+        }
+        memcpy(prev, line, line_bytes);
+        have_prev = true;
+        starred = false;
+
+        //address
+        out = hex::format_hex32(out, static_cast<uint32_t>(i));
+        *out++ = ':';
+        *out++ = ' ';
+
+        //bytes in hex
+        for(size_t b = 0; b < line_bytes; b++)
+        {
+            out = hex::format_hex8(out, line[b]);
+            *out++ = ' ';
         }
 
         //some spaces to make the dump formatted
-         cout << " ";
+        *out++ = ' ';
+
+        //prints non-compatible as .
+        for(size_t b = 0; b < line_bytes; b++)
+        {
+            *out++ = dump_text.text[line[b]];
+        }
+        *out++ = '\n';
+
+        if(out + line_chars > buf + buf_lines * line_chars)
+        {
+            cout.write(buf, out - buf);
+            out = buf;
+        }
+    }
 
+    cout.write(buf, out - buf);
+    cout.flush();
+    delete[] buf;
+}
+
+/*************************************************************************
+Function: copy_in
 
+Use: copies a block of host bytes into guest memory
 
-        for(size_t s = 0; s < line_bytes; s++)
+Arguments: 1. addr: the first guest address to write
+           2. src: the bytes to copy
+           3. len: how many bytes to copy
+
+Returns: nothing
+
+Notes: the caller has already range checked the whole block, this walks
+it a page at a time with one memcpy each
+
+ ************************************************************************/
+void memory::copy_in(uint32_t addr, const uint8_t *src, uint64_t len)
+{
+    clear_code(addr, len);
+    if(guard_base)
+    {
+        memcpy(guard_base + addr, src, len);
+        return;
+    }
+
+    while(len > 0)
+    {
+        uint32_t off = addr & page_mask;
+        uint64_t n = page_size - off;
+        if(n > len)
         {
-            if(i + s < mem.size())
-            {
-                uint8_t ch = get8(i + s);
-                //prints non-compatible as .
-                ch = isprint(ch) ? ch : '.';
-                cout << static_cast<char>(ch);
+            n = len;
+        }
+        memcpy(page(addr) + off, src, n);
+        addr += n;
+        src += n;
+        len -= n;
+    }
+}
+
+/*************************************************************************
+Function: mark_code
 
+Use: notes that the code line holding addr has been predecoded, so that a
+later write to it invalidates whatever was decoded
 
-            }
-            else{
-                //some spaces to make the dump formatted
-                cout << " ";
-            }
+Arguments: 1. addr: a guest address inside memory
+
+Returns: nothing
+
+ ************************************************************************/
+void memory::mark_code(uint32_t addr)
+{
+    if(addr < size)
+    {
+        code_lines[addr >> code_line_bits].store(1, std::memory_order_relaxed);
+    }
+}
+
+/*************************************************************************
+Function: clear_code
+
+Use: drops the code marks on every line in a range, bumping the code
+epoch if any were set
+
+Arguments: 1. addr: the first guest address written
+           2. len: how many bytes were written
+
+Returns: nothing
+
+Notes: the caller has already range checked the block
+
+ ************************************************************************/
+void memory::clear_code(uint32_t addr, uint64_t len)
+{
+    if(len == 0)
+    {
+        return;
+    }
+    uint64_t last = (static_cast<uint64_t>(addr) + len - 1) >> code_line_bits;
+    bool hit = false;
+    for(uint64_t p = addr >> code_line_bits; p <= last; p++)
+    {
+        if(code_lines[p].load(std::memory_order_relaxed) != 0 &&
+           code_lines[p].exchange(0, std::memory_order_relaxed) != 0)
+        {
+            hit = true;
+        }
+    }
+    if(hit)
+    {
+        code_epoch.fetch_add(1, std::memory_order_release);
+    }
+}
+
+/*************************************************************************
+Function: copy_out
+
+Use: copies a block of guest memory out to host bytes
+
+Arguments: 1. addr: the first guest address to read
+           2. dst: where to put the bytes
+           3. len: how many bytes to copy
+
+Returns: nothing
+
+Notes: the caller has already range checked the whole block, untouched
+pages are read from the fill page without being allocated
+
+ ************************************************************************/
+void memory::copy_out(uint32_t addr, uint8_t *dst, uint64_t len) const
+{
+    if(guard_base)
+    {
+        memcpy(dst, guard_base + addr, len);
+        return;
+    }
+
+    while(len > 0)
+    {
+        uint32_t off = addr & page_mask;
+        uint64_t n = page_size - off;
+        if(n > len)
+        {
+            n = len;
         }
+        memcpy(dst, read_page(addr) + off, n);
+        addr += n;
+        dst += n;
+        len -= n;
+    }
+}
+
+/*************************************************************************
+Function: fill_in
+
+Use: sets a block of guest memory to one byte value
+
+Arguments: 1. addr: the first guest address to write
+           2. val: the byte to store
+           3. len: how many bytes to set
+
+Returns: nothing
+
+Notes: the caller has already range checked the whole block
 
-        cout << endl;
+ ************************************************************************/
+void memory::fill_in(uint32_t addr, uint8_t val, uint64_t len)
+{
+    clear_code(addr, len);
+    if(guard_base)
+    {
+        memset(guard_base + addr, val, len);
+        return;
+    }
+
+    while(len > 0)
+    {
+        uint32_t off = addr & page_mask;
+        uint64_t n = page_size - off;
+        if(n > len)
+        {
+            n = len;
+        }
+        memset(page(addr) + off, val, n);
+        addr += n;
+        len -= n;
     }
 }
 
+/*************************************************************************
+Function: map_image
+
+Use: maps a file image straight into guarded guest memory at address 0
+
+Arguments: 1. fd: the open image file
+           2. len: the size of the file in bytes
+
+Returns: true if the image was mapped, false if the caller should copy
+
+Notes: the file pages are mapped MAP_PRIVATE over the reservation so
+the guest gets copy-on-write access without reading the file up front.
+Only works when guest address 0 is page aligned on the host.
+
+ ************************************************************************/
+bool memory::map_image(int fd, uint64_t len)
+{
+    if(guard_base == nullptr || (reinterpret_cast<uintptr_t>(guard_base) & page_mask) != 0)
+    {
+        return false;
+    }
+
+    size_t maplen = (len + page_mask) & ~static_cast<uint64_t>(page_mask);
+    void *p = mmap(guard_base, maplen, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_FIXED, fd, 0);
+    if(p == MAP_FAILED)
+    {
+        return false;
+    }
+
+    // the rest of the last page reads as zero from the file, guest memory
+    // past the image still has to look like the usual 0xA5 fill
+    memset(guard_base + len, 0xA5, maplen - len);
+    return true;
+}
+
 /*************************************************************************
 Function: load_file
 
@@ -335,36 +1420,209 @@ Arguments: 1. fname: the npath to the file that we want to load
 
 Returns: true if the file is loaded, false if not
 
-Notes: Makes sure the string is 2 chars long
+Notes: the file is memory mapped and moved into guest memory in bulk,
+either by mapping it in place (guarded mode) or one memcpy per page
 
  ************************************************************************/
 bool memory::load_file(const string &fname)
 {
-    ifstream infile(fname, std::ios::binary);
-    if (!infile)
+    int fd = open(fname.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        cerr << "Can't open file '" << fname << "' for reading." << endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
     {
         cerr << "Can't open file '" << fname << "' for reading." << endl;
+        close(fd);
         return false;
     }
 
-    uint32_t addr = 0;
-    uint8_t byte;
-    while (infile.read((char *)&byte, 1))
+    uint64_t len = st.st_size;
+    if (len > get_size())
     {
-        if (addr >= get_size())
+        cerr << "Program too big." << endl;
+        close(fd);
+        return false;
+    }
+
+    clear_code(0, len);
+    if (len > 0 && !map_image(fd, len))
+    {
+        void *img = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (img == MAP_FAILED)
         {
-            cerr << "Program too big." << endl;
-            infile.close();
+            cerr << "Can't open file '" << fname << "' for reading." << endl;
+            close(fd);
             return false;
         }
-        mem[addr++] = byte;
+        copy_in(0, static_cast<const uint8_t *>(img), len);
+        munmap(img, len);
     }
-    infile.close();
+    close(fd);
 
     
-    if (addr > 0)
+    if (len > 0)
+    {
+        last_address = (len - 1) & ~0x3; 
+    }
+    else
+    {
+        last_address = 0;
+    }
+    return true;
+}
+
+/*************************************************************************
+Function: get_last_address
+
+Use: Gets the address of the last word loaded by load_file
+
+Arguments: none
+
+Returns: the word aligned address of the last loaded byte
+
+ ************************************************************************/
+uint32_t memory::get_last_address() const
+{
+    return last_address;
+}
+
+//little-endian field readers for the ELF headers
+static uint16_t elf16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t elf32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+/*************************************************************************
+Function: is_elf
+
+Use: checks whether a file starts with the ELF magic number
+
+Arguments: 1. fname: the path to the file
+
+Returns: true if the file looks like an ELF image
+
+ ************************************************************************/
+bool memory::is_elf(const string &fname)
+{
+    int fd = open(fname.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    uint8_t magic[4];
+    bool elf = read(fd, magic, sizeof(magic)) == sizeof(magic)
+        && magic[0] == 0x7f && magic[1] == 'E' && magic[2] == 'L' && magic[3] == 'F';
+    close(fd);
+    return elf;
+}
+
+/*************************************************************************
+Function: load_elf
+
+Use: loads the PT_LOAD segments of an ELF32 RISC-V executable
+
+Arguments: 1. fname: the path to the ELF file
+           2. entry: set to the program entry point on success
+
+Returns: true if the file is loaded, false if not
+
+Notes: the file is memory mapped and each segment is copied in one block
+at its virtual address. The .bss part of a segment (memsz past filesz)
+is zero filled without reading anything from the file. last_address is
+the last word of file backed data.
+
+ ************************************************************************/
+bool memory::load_elf(const string &fname, uint32_t &entry)
+{
+    int fd = open(fname.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        cerr << "Can't open file '" << fname << "' for reading." << endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < 52)
+    {
+        cerr << "Not an ELF32 RISC-V executable: '" << fname << "'" << endl;
+        close(fd);
+        return false;
+    }
+
+    uint64_t len = st.st_size;
+    void *map = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        cerr << "Can't open file '" << fname << "' for reading." << endl;
+        return false;
+    }
+    const uint8_t *img = static_cast<const uint8_t *>(map);
+
+    // 32 bit, little-endian, executable, EM_RISCV
+    bool ok = img[0] == 0x7f && img[1] == 'E' && img[2] == 'L' && img[3] == 'F'
+        && img[4] == 1 && img[5] == 1
+        && elf16(img + 16) == 2 && elf16(img + 18) == 243;
+    uint32_t phoff = elf32(img + 28);
+    uint16_t phentsize = elf16(img + 42);
+    uint16_t phnum = elf16(img + 44);
+    if (!ok || phentsize < 32 || phoff + static_cast<uint64_t>(phentsize) * phnum > len)
+    {
+        cerr << "Not an ELF32 RISC-V executable: '" << fname << "'" << endl;
+        munmap(map, len);
+        return false;
+    }
+
+    uint64_t top = 0;
+    for (uint16_t i = 0; i < phnum; i++)
+    {
+        const uint8_t *ph = img + phoff + i * phentsize;
+        if (elf32(ph) != 1)
+        {
+            continue;   // only PT_LOAD segments occupy memory
+        }
+        uint32_t offset = elf32(ph + 4);
+        uint32_t vaddr = elf32(ph + 8);
+        uint32_t filesz = elf32(ph + 16);
+        uint32_t memsz = elf32(ph + 20);
+
+        if (filesz > memsz || static_cast<uint64_t>(offset) + filesz > len)
+        {
+            cerr << "Bad segment in '" << fname << "'" << endl;
+            munmap(map, len);
+            return false;
+        }
+        if (static_cast<uint64_t>(vaddr) + memsz > get_size())
+        {
+            cerr << "Program too big." << endl;
+            munmap(map, len);
+            return false;
+        }
+
+        copy_in(vaddr, img + offset, filesz);
+        fill_in(vaddr + filesz, 0, memsz - filesz);
+        if (filesz > 0 && static_cast<uint64_t>(vaddr) + filesz > top)
+        {
+            top = static_cast<uint64_t>(vaddr) + filesz;
+        }
+    }
+
+    entry = elf32(img + 24);
+    munmap(map, len);
+
+    if (top > 0)
     {
-        last_address = (addr - 1) & ~0x3; 
+        last_address = (top - 1) & ~0x3;
     }
     else
     {
@@ -12,18 +12,61 @@
 #ifndef MEMORY_H
 #define MEMORY_H
 
-#include <vector>
 #include <cstdint>
 #include <string>
+#include <atomic>
+#include <mutex>
+#include <csetjmp>
+#include <signal.h>
 #include "hex.h"
 
 class memory : public hex
 {
     public:
-        memory(uint32_t s);
+        //guest memory is backed by pages allocated on first write
+        static const uint32_t page_bits = 12;
+        static const uint32_t page_size = 1u << page_bits;
+        static const uint32_t page_mask = page_size - 1;
+
+        //how the guest address space is backed on the host
+        enum backing_mode
+        {
+            backing_paged,      //page table, every access is range checked
+            backing_guarded     //4 GiB host reservation, host faults do the checking
+        };
+
+        memory(uint32_t s, backing_mode mode = backing_paged);
         ~memory();
-        bool check_illegal(uint32_t addr) const;
-        uint32_t get_size() const;
+        memory(const memory &) = delete;
+        memory &operator=(const memory &) = delete;
+        //what an out of range access was trying to do
+        enum fault_kind
+        {
+            fault_read,
+            fault_write,
+            fault_fetch
+        };
+
+        //one out of range access, pc is filled in by the hart
+        struct fault
+        {
+            uint32_t addr;
+            uint32_t width;
+            fault_kind kind;
+            uint32_t pc;
+        };
+
+        static const uint32_t default_warning_limit = 10;
+
+        bool check_illegal(uint32_t addr, uint32_t len = 1, fault_kind kind = fault_read) const;
+        bool take_fault(fault &f);
+        uint64_t get_fault_count() const;
+        uint64_t get_fault_count(fault_kind kind) const;
+        void set_fault_warnings(uint32_t limit);
+        bool is_guarded() const { return guard_base != nullptr; }
+        template<typename F> bool guarded_call(F &&f) const;
+        static uint32_t get_guard_fault_addr();
+        uint64_t get_size() const;
         uint8_t get8(uint32_t addr) const;
         uint16_t get16(uint32_t addr) const;
         uint32_t get32(uint32_t addr) const;
@@ -33,17 +76,144 @@ class memory : public hex
         void set8(uint32_t addr, uint8_t val);
         void set16(uint32_t addr, uint16_t val);
         void set32(uint32_t addr, uint32_t val);
+
+        //atomic read-modify-write of an aligned word, for the A extension
+        enum amo_op
+        {
+            amo_swap,
+            amo_add,
+            amo_xor,
+            amo_and,
+            amo_or,
+            amo_min,
+            amo_max,
+            amo_minu,
+            amo_maxu
+        };
+        uint32_t get32_atomic(uint32_t addr) const;
+        uint32_t amo32(uint32_t addr, amo_op op, uint32_t val);
+        bool cmpxchg32(uint32_t addr, uint32_t expected, uint32_t val);
+
+        bool read_block(uint32_t addr, void *dst, uint32_t len) const;
+        bool write_block(uint32_t addr, const void *src, uint32_t len);
+        bool fill(uint32_t addr, uint8_t val, uint32_t len);
         void dump() const;
+        void dump(uint32_t first, uint64_t len, bool squeeze = true) const;
         bool load_file(const std::string &fname);
+        bool load_elf(const std::string &fname, uint32_t &entry);
+        static bool is_elf(const std::string &fname);
         uint32_t get_last_address() const;
 
+        //predecoded code tracking, any write to a marked line bumps the epoch.
+        //lines are much smaller than pages so data next to code does not
+        //keep throwing the decoded code away
+        static const uint32_t code_line_bits = 6;
+        void mark_code(uint32_t addr);
+        uint64_t get_code_epoch() const { return code_epoch.load(std::memory_order_acquire); }
+
     
     
     private:
-        //vector representing the memory
-        std::vector<uint8_t> mem;
+        const uint8_t *read_page(uint32_t addr) const;
+        uint8_t *page(uint32_t addr);
+        uint8_t *alloc_page(uint32_t addr);
+        uint32_t *atomic_word(uint32_t addr);
+        bool map_guarded();
+        void unmap_guarded();
+        void copy_in(uint32_t addr, const uint8_t *src, uint64_t len);
+        void copy_out(uint32_t addr, uint8_t *dst, uint64_t len) const;
+        void fill_in(uint32_t addr, uint8_t val, uint64_t len);
+        //a plain range check for host side accesses, which are not guest faults
+        bool in_range(uint32_t addr, uint32_t len) const
+        {
+            return static_cast<uint64_t>(addr) + len <= size;
+        }
+        void clear_code(uint32_t addr, uint64_t len);
+        void note_write(uint32_t addr, uint32_t len)
+        {
+            // stores are at most 4 bytes, so at most two lines to look at
+            if((code_lines[addr >> code_line_bits].load(std::memory_order_relaxed) |
+                code_lines[(addr + len - 1) >> code_line_bits].load(std::memory_order_relaxed)) != 0)
+            {
+                clear_code(addr, len);
+            }
+        }
+        bool map_image(int fd, uint64_t len);
+        static void guard_fault_handler(int sig, siginfo_t *info, void *uctx);
+        void record_fault(uint32_t addr, uint32_t width, fault_kind kind) const;
+        void record_guard_fault() const;
+
+        //page table, one slot per 4 KiB page, null until the page is written.
+        //harts on other threads may share the memory, so slots are published
+        //atomically and page_lock keeps two of them from allocating one page
+        std::atomic<uint8_t *> *pages = nullptr;
+        std::mutex page_lock;
+        uint64_t page_count = 0;
+        uint64_t size = 0;
         uint32_t last_address = 0;
 
+        //one flag per code line, set while the line holds predecoded code
+        std::atomic<uint8_t> *code_lines = nullptr;
+        std::atomic<uint64_t> code_epoch{0};
+
+        //fault bookkeeping, mutable since reads can fault too. A fault is
+        //taken by the hart on the thread that made it, so the pending one is
+        //kept per thread
+        static thread_local fault last_fault;
+        static thread_local const memory *fault_owner;
+        mutable std::atomic<uint64_t> fault_counts[3] = {};
+        mutable std::atomic<uint32_t> warnings_printed{0};
+        uint32_t warning_limit = default_warning_limit;
+
+        //guarded mode: guest address 0 lives at guard_base, the reservation
+        //starts a little lower so that guard_base + size is page aligned
+        uint8_t *guard_base = nullptr;
+        uint8_t *guard_region = nullptr;
+        size_t guard_length = 0;
+        uint8_t *guard_touched = nullptr;  //one flag per host page, set once filled
+
+        //recovery point for the thread currently inside guarded_call
+        static thread_local sigjmp_buf *guard_env;
+        static thread_local uint32_t guard_fault_addr;
+        static thread_local bool guard_fault_write;
 };
 
+/*************************************************************************
+Function: guarded_call
+
+Use: runs f with guest access faults in guarded memory turned into a
+false return instead of a host crash
+
+Arguments: 1. f: the callable to run, typically one hart step
+
+Returns: true if f finished, false if it touched an address past the
+end of guest memory, in which case the fault has been recorded
+
+Notes: f is abandoned at the faulting access, so it must not hold
+resources that need unwinding. In paged mode f is simply called.
+
+ ************************************************************************/
+template<typename F>
+bool memory::guarded_call(F &&f) const
+{
+    if(guard_base == nullptr)
+    {
+        f();
+        return true;
+    }
+
+    sigjmp_buf env;
+    sigjmp_buf *prev = guard_env;
+    guard_env = &env;
+    if(sigsetjmp(env, 0) != 0)
+    {
+        guard_env = prev;
+        record_guard_fault();
+        return false;
+    }
+    f();
+    guard_env = prev;
+    return true;
+}
+
 #endif
\ No newline at end of file
@@ -93,6 +93,50 @@ public:
     ************************************************************************/
     void dump(const std::string &hdr = "") const;
 
+    /*************************************************************************
+    Function: get_unchecked
+
+    Use: Retrieves a register for the execution core, without a range check.
+
+    Arguments:
+    1. uint32_t reg: The register number, a 5 bit instruction field.
+
+    Returns: uint32_t: The value of the register, 0 for x0.
+
+    ************************************************************************/
+    uint32_t get_unchecked(uint32_t reg) const { return regs_[reg]; }
+
+    /*************************************************************************
+    Function: set_unchecked
+
+    Use: Sets a register for the execution core, without a range check and
+         without testing for x0. A write to x0 lands and is zeroed again
+         straight away, which is cheaper than the branch.
+
+    Arguments:
+    1. uint32_t reg: The register number, a 5 bit instruction field.
+    2. uint32_t value: The value to set.
+
+    ************************************************************************/
+    void set_unchecked(uint32_t reg, uint32_t value)
+    {
+        regs_[reg] = value;
+        regs_[0] = 0;
+    }
+
+    /*************************************************************************
+    Function: data
+
+    Use: Gives translated code direct access to the registers. x0 is
+         read as zero there too, so writes to it must still be dropped.
+
+    Arguments: None
+
+    Returns: uint32_t *: The 32 registers, x0 first.
+
+    ************************************************************************/
+    uint32_t *data() { return regs_; }
+
 private:
     uint32_t regs_[32]; // General-purpose registers x0 to x31
 };
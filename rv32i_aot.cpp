@@ -0,0 +1,639 @@
+//*************************************************************************
+// Ryan Scaglione
+// z1996413
+// CSCI463 - PE1
+//
+// I certify that this is my own work, and where applicable an extension
+// of the starter code for the assignment
+//
+//*************************************************************************
+
+#include "rv32i_aot.h"
+#include "rv32i_decode.h"
+#include "hex.h"
+
+#include <set>
+#include <vector>
+#include <sstream>
+#include <cstdlib>
+#include <unistd.h>
+
+/*************************************************************************
+Function: reg
+
+Use: Renders a guest register read for the emitted code. x0 is a constant.
+
+Arguments:
+1. uint32_t r: The register number.
+
+Returns: std::string: The C++ expression.
+
+ ************************************************************************/
+static std::string reg(uint32_t r)
+{
+    return r == 0 ? std::string("0u") : "x[" + std::to_string(r) + "]";
+}
+
+/*************************************************************************
+Function: lit
+
+Use: Renders a 32 bit constant for the emitted code.
+
+Arguments:
+1. uint32_t v: The value.
+
+Returns: std::string: An unsigned hex literal.
+
+ ************************************************************************/
+static std::string lit(uint32_t v)
+{
+    return hex::to_hex0x32(v) + "u";
+}
+
+/*************************************************************************
+Function: is_translated
+
+Use: Tells whether translate() turns an operation into C++. Everything
+     else is left to the interpreter.
+
+Arguments:
+1. uint8_t op: The rv32i_decode::insn_op to classify.
+
+Returns: bool: true for the RV32I computational, load, store, jump and
+     branch instructions, the ones emit_insn() knows.
+
+ ************************************************************************/
+bool rv32i_aot::is_translated(uint8_t op)
+{
+    switch(op)
+    {
+        case rv32i_decode::op_lui:
+        case rv32i_decode::op_auipc:
+        case rv32i_decode::op_jal:
+        case rv32i_decode::op_jalr:
+        case rv32i_decode::op_beq:
+        case rv32i_decode::op_bne:
+        case rv32i_decode::op_blt:
+        case rv32i_decode::op_bge:
+        case rv32i_decode::op_bltu:
+        case rv32i_decode::op_bgeu:
+        case rv32i_decode::op_lb:
+        case rv32i_decode::op_lh:
+        case rv32i_decode::op_lw:
+        case rv32i_decode::op_lbu:
+        case rv32i_decode::op_lhu:
+        case rv32i_decode::op_sb:
+        case rv32i_decode::op_sh:
+        case rv32i_decode::op_sw:
+        case rv32i_decode::op_addi:
+        case rv32i_decode::op_slti:
+        case rv32i_decode::op_sltiu:
+        case rv32i_decode::op_xori:
+        case rv32i_decode::op_ori:
+        case rv32i_decode::op_andi:
+        case rv32i_decode::op_slli:
+        case rv32i_decode::op_srli:
+        case rv32i_decode::op_srai:
+        case rv32i_decode::op_add:
+        case rv32i_decode::op_sub:
+        case rv32i_decode::op_sll:
+        case rv32i_decode::op_slt:
+        case rv32i_decode::op_sltu:
+        case rv32i_decode::op_xor:
+        case rv32i_decode::op_srl:
+        case rv32i_decode::op_sra:
+        case rv32i_decode::op_or:
+        case rv32i_decode::op_and:
+        case rv32i_decode::op_mul:
+        case rv32i_decode::op_mulh:
+        case rv32i_decode::op_mulhsu:
+        case rv32i_decode::op_mulhu:
+        case rv32i_decode::op_div:
+        case rv32i_decode::op_divu:
+        case rv32i_decode::op_rem:
+        case rv32i_decode::op_remu:
+        case rv32i_decode::op_sh1add:
+        case rv32i_decode::op_sh2add:
+        case rv32i_decode::op_sh3add:
+        case rv32i_decode::op_andn:
+        case rv32i_decode::op_orn:
+        case rv32i_decode::op_xnor:
+        case rv32i_decode::op_clz:
+        case rv32i_decode::op_ctz:
+        case rv32i_decode::op_cpop:
+        case rv32i_decode::op_sext_b:
+        case rv32i_decode::op_sext_h:
+        case rv32i_decode::op_min:
+        case rv32i_decode::op_minu:
+        case rv32i_decode::op_max:
+        case rv32i_decode::op_maxu:
+        case rv32i_decode::op_zext_h:
+        case rv32i_decode::op_rol:
+        case rv32i_decode::op_ror:
+        case rv32i_decode::op_rori:
+        case rv32i_decode::op_rev8:
+        case rv32i_decode::op_orc_b:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/*************************************************************************
+Function: emit_exit
+
+Use: Emits leaving a block early, before or after instruction k.
+
+Arguments:
+1. std::ostream &os: Where the code goes.
+2. uint32_t pc: Where the guest continues.
+3. uint32_t done: Instructions of the block completed so far.
+
+ ************************************************************************/
+static void emit_exit(std::ostream &os, uint32_t pc, uint32_t done)
+{
+    os << "        {\n"
+       << "            s.pc = " << lit(pc) << ";\n";
+    if(done != 0) {
+        os << "            s.left -= " << done << ";\n";
+    }
+    os << "            return false;\n"
+       << "        }\n";
+}
+
+/*************************************************************************
+Function: emit_insn
+
+Use: Emits the C++ for one instruction of a block. Control ops only
+     compute s.pc, the caller closes the block.
+
+Arguments:
+1. std::ostream &os: Where the code goes.
+2. const rv32i_decode::decoded_insn &d: The instruction, d.pc set.
+3. uint32_t k: Its index in the block.
+
+ ************************************************************************/
+static void emit_insn(std::ostream &os, const rv32i_decode::decoded_insn &d, uint32_t k)
+{
+    uint32_t imm = static_cast<uint32_t>(d.imm);
+    std::string rd = "x[" + std::to_string(d.rd) + "] = ";
+    std::string r1 = reg(d.rs1);
+    std::string r2 = reg(d.rs2);
+    std::string s1 = "static_cast<int32_t>(" + r1 + ")";
+    std::string s2 = "static_cast<int32_t>(" + r2 + ")";
+    std::string expr;
+    uint32_t width = 0;
+    bool store = false;
+
+    switch(d.op)
+    {
+        // Jumps and branches only pick the next pc
+        case rv32i_decode::op_jal:
+            if(d.rd != 0) {
+                os << "    " << rd << lit(d.pc + 4) << ";\n";
+            }
+            os << "    s.pc = " << lit(d.pc + imm) << ";\n";
+            return;
+        case rv32i_decode::op_jalr:
+            os << "    s.pc = (" << r1 << " + " << lit(imm) << ") & ~1u;\n";
+            if(d.rd != 0) {
+                os << "    " << rd << lit(d.pc + 4) << ";\n";
+            }
+            return;
+        case rv32i_decode::op_beq:  expr = r1 + " == " + r2; break;
+        case rv32i_decode::op_bne:  expr = r1 + " != " + r2; break;
+        case rv32i_decode::op_blt:  expr = s1 + " < " + s2; break;
+        case rv32i_decode::op_bge:  expr = s1 + " >= " + s2; break;
+        case rv32i_decode::op_bltu: expr = r1 + " < " + r2; break;
+        case rv32i_decode::op_bgeu: expr = r1 + " >= " + r2; break;
+
+        // Loads and stores are range checked here, so that memory never
+        // sees an access it would fault on
+        case rv32i_decode::op_lb:  width = 1; expr = "m.get8_sx(a)"; break;
+        case rv32i_decode::op_lh:  width = 2; expr = "m.get16_sx(a)"; break;
+        case rv32i_decode::op_lw:  width = 4; expr = "m.get32(a)"; break;
+        case rv32i_decode::op_lbu: width = 1; expr = "m.get8(a)"; break;
+        case rv32i_decode::op_lhu: width = 2; expr = "m.get16(a)"; break;
+        case rv32i_decode::op_sb:  width = 1; store = true; expr = "m.set8(a, " + r2 + " & 0xffu)"; break;
+        case rv32i_decode::op_sh:  width = 2; store = true; expr = "m.set16(a, " + r2 + " & 0xffffu)"; break;
+        case rv32i_decode::op_sw:  width = 4; store = true; expr = "m.set32(a, " + r2 + ")"; break;
+
+        // Everything else only writes rd
+        case rv32i_decode::op_lui:   expr = lit(imm); break;
+        case rv32i_decode::op_auipc: expr = lit(d.pc + imm); break;
+        case rv32i_decode::op_addi:  expr = r1 + " + " + lit(imm); break;
+        case rv32i_decode::op_slti:  expr = s1 + " < " + std::to_string(d.imm); break;
+        case rv32i_decode::op_sltiu: expr = r1 + " < " + lit(imm); break;
+        case rv32i_decode::op_xori:  expr = r1 + " ^ " + lit(imm); break;
+        case rv32i_decode::op_ori:   expr = r1 + " | " + lit(imm); break;
+        case rv32i_decode::op_andi:  expr = r1 + " & " + lit(imm); break;
+        case rv32i_decode::op_slli:  expr = r1 + " << " + std::to_string(imm); break;
+        case rv32i_decode::op_srli:  expr = r1 + " >> " + std::to_string(imm); break;
+        case rv32i_decode::op_srai:  expr = s1 + " >> " + std::to_string(imm); break;
+        case rv32i_decode::op_add:   expr = r1 + " + " + r2; break;
+        case rv32i_decode::op_sub:   expr = r1 + " - " + r2; break;
+        case rv32i_decode::op_sll:   expr = r1 + " << (" + r2 + " & 31)"; break;
+        case rv32i_decode::op_slt:   expr = s1 + " < " + s2; break;
+        case rv32i_decode::op_sltu:  expr = r1 + " < " + r2; break;
+        case rv32i_decode::op_xor:   expr = r1 + " ^ " + r2; break;
+        case rv32i_decode::op_srl:   expr = r1 + " >> (" + r2 + " & 31)"; break;
+        case rv32i_decode::op_sra:   expr = s1 + " >> (" + r2 + " & 31)"; break;
+        case rv32i_decode::op_or:    expr = r1 + " | " + r2; break;
+        case rv32i_decode::op_and:   expr = r1 + " & " + r2; break;
+
+        // RV32M, with division by zero and INT_MIN / -1 sorted out before
+        // the host divide can fault on them
+        case rv32i_decode::op_mul:    expr = r1 + " * " + r2; break;
+        case rv32i_decode::op_mulh:   expr = "static_cast<uint64_t>(static_cast<int64_t>(" + s1 + ") * " + s2 + ") >> 32"; break;
+        case rv32i_decode::op_mulhsu: expr = "static_cast<uint64_t>(static_cast<int64_t>(" + s1 + ") * static_cast<int64_t>(" + r2 + ")) >> 32"; break;
+        case rv32i_decode::op_mulhu:  expr = "static_cast<uint64_t>(" + r1 + ") * " + r2 + " >> 32"; break;
+        case rv32i_decode::op_div:
+            expr = r2 + " == 0u ? 0xffffffffu : (" + r1 + " == 0x80000000u && " + r2 + " == 0xffffffffu) ? " + r1
+                 + " : static_cast<uint32_t>(" + s1 + " / " + s2 + ")";
+            break;
+        case rv32i_decode::op_divu:   expr = r2 + " == 0u ? 0xffffffffu : " + r1 + " / " + r2; break;
+        case rv32i_decode::op_rem:
+            expr = r2 + " == 0u ? " + r1 + " : (" + r1 + " == 0x80000000u && " + r2 + " == 0xffffffffu) ? 0u"
+                 + " : static_cast<uint32_t>(" + s1 + " % " + s2 + ")";
+            break;
+        case rv32i_decode::op_remu:   expr = r2 + " == 0u ? " + r1 + " : " + r1 + " % " + r2; break;
+
+        // Zba and Zbb, clz and ctz have to keep 0 away from the builtins
+        case rv32i_decode::op_sh1add: expr = "(" + r1 + " << 1) + " + r2; break;
+        case rv32i_decode::op_sh2add: expr = "(" + r1 + " << 2) + " + r2; break;
+        case rv32i_decode::op_sh3add: expr = "(" + r1 + " << 3) + " + r2; break;
+        case rv32i_decode::op_andn:   expr = r1 + " & ~" + r2; break;
+        case rv32i_decode::op_orn:    expr = r1 + " | ~" + r2; break;
+        case rv32i_decode::op_xnor:   expr = "~(" + r1 + " ^ " + r2 + ")"; break;
+        case rv32i_decode::op_clz:    expr = r1 + " == 0u ? 32 : __builtin_clz(" + r1 + ")"; break;
+        case rv32i_decode::op_ctz:    expr = r1 + " == 0u ? 32 : __builtin_ctz(" + r1 + ")"; break;
+        case rv32i_decode::op_cpop:   expr = "__builtin_popcount(" + r1 + ")"; break;
+        case rv32i_decode::op_sext_b: expr = "static_cast<int8_t>(" + r1 + ")"; break;
+        case rv32i_decode::op_sext_h: expr = "static_cast<int16_t>(" + r1 + ")"; break;
+        case rv32i_decode::op_min:    expr = s1 + " < " + s2 + " ? " + r1 + " : " + r2; break;
+        case rv32i_decode::op_minu:   expr = r1 + " < " + r2 + " ? " + r1 + " : " + r2; break;
+        case rv32i_decode::op_max:    expr = s1 + " < " + s2 + " ? " + r2 + " : " + r1; break;
+        case rv32i_decode::op_maxu:   expr = r1 + " < " + r2 + " ? " + r2 + " : " + r1; break;
+        case rv32i_decode::op_zext_h: expr = r1 + " & 0xffffu"; break;
+        case rv32i_decode::op_rol:    expr = "(" + r1 + " << (" + r2 + " & 31)) | (" + r1 + " >> ((32u - " + r2 + ") & 31))"; break;
+        case rv32i_decode::op_ror:    expr = "(" + r1 + " >> (" + r2 + " & 31)) | (" + r1 + " << ((32u - " + r2 + ") & 31))"; break;
+        case rv32i_decode::op_rori:
+            expr = "(" + r1 + " >> " + std::to_string(imm) + ") | (" + r1 + " << " + std::to_string((32 - imm) & 31) + ")";
+            break;
+        case rv32i_decode::op_rev8:   expr = "__builtin_bswap32(" + r1 + ")"; break;
+        case rv32i_decode::op_orc_b:
+            expr = "(((((" + r1 + " & 0x7f7f7f7fu) + 0x7f7f7f7fu) | " + r1 + ") & 0x80808080u) >> 7) * 0xffu";
+            break;
+        default:
+            return;
+    }
+
+    if(rv32i_hart::is_control(d.op)) {
+        os << "    s.pc = (" << expr << ") ? " << lit(d.pc + imm) << " : " << lit(d.pc + 4) << ";\n";
+        return;
+    }
+
+    if(width != 0) {
+        os << "    {\n"
+           << "        uint32_t a = " << r1 << " + " << lit(imm) << ";\n"
+           << "        if(a + " << width << "ull > s.size)\n";
+        emit_exit(os, d.pc, k);
+        if(store) {
+            // A store into the image leaves the rest of it to be checked
+            os << "        " << expr << ";\n"
+               << "        if(m.get_code_epoch() != s.epoch)\n";
+            emit_exit(os, d.pc + 4, k + 1);
+        }
+        else if(d.rd != 0) {
+            os << "        " << rd << expr << ";\n";
+        }
+        os << "    }\n";
+        return;
+    }
+
+    if(d.rd != 0) {
+        os << "    " << rd << "static_cast<uint32_t>(" << expr << ");\n";
+    }
+}
+
+/*************************************************************************
+Function: translate
+
+Use: Writes a C++ translation of the code in mem reachable from entry.
+
+Arguments:
+1. const memory &mem: The loaded image.
+2. uint32_t entry: Where execution starts.
+3. std::ostream &os: Where the C++ goes.
+
+Returns: bool: false if there was nothing to translate.
+
+Notes: reachable means found by following fall through, branch and jal
+     targets, the return address after a call, and jalr targets that an
+     auipc right before it makes constant. Anything only reached through
+     other indirect jumps is run by the interpreter.
+
+ ************************************************************************/
+bool rv32i_aot::translate(const memory &mem, uint32_t entry, std::ostream &os)
+{
+    uint64_t size = mem.get_size();
+
+    // Find every block leader, scanning each run of code once
+    std::set<uint32_t> leaders;
+    std::set<uint32_t> scanned;
+    std::vector<uint32_t> work(1, entry);
+    while(!work.empty()) {
+        uint32_t pc = work.back();
+        work.pop_back();
+        if((pc & 3) != 0 || pc + 4ull > size || !leaders.insert(pc).second) {
+            continue;
+        }
+
+        rv32i_decode::decoded_insn prev = {};
+        for(uint32_t a = pc; a + 4ull <= size && scanned.insert(a).second; a += 4) {
+            rv32i_decode::decoded_insn d = rv32i_decode::predecode(mem.get32(a));
+            if(!is_translated(d.op)) {
+                // The interpreter runs it and comes back after it
+                if(d.op != rv32i_decode::op_illegal) {
+                    work.push_back(a + 4);
+                }
+                break;
+            }
+            if(!rv32i_hart::is_control(d.op)) {
+                prev = d;
+                prev.pc = a;
+                continue;
+            }
+
+            uint32_t imm = static_cast<uint32_t>(d.imm);
+            if(d.op == rv32i_decode::op_jal) {
+                work.push_back(a + imm);
+            }
+            else if(d.op == rv32i_decode::op_jalr) {
+                if(a != pc && prev.op == rv32i_decode::op_auipc && prev.rd != 0 && prev.rd == d.rs1) {
+                    work.push_back((prev.pc + static_cast<uint32_t>(prev.imm) + imm) & ~1u);
+                }
+            }
+            else {
+                work.push_back(a + imm);
+            }
+            // A call comes back to the next instruction, and a branch
+            // can fall through to it
+            bool is_jump = d.op == rv32i_decode::op_jal || d.op == rv32i_decode::op_jalr;
+            if(!is_jump || d.rd != 0) {
+                work.push_back(a + 4);
+            }
+            break;
+        }
+    }
+
+    // One function per block, running to the first control op, the first
+    // instruction left to the interpreter or the next leader
+    std::ostringstream code;
+    std::ostringstream words;
+    std::ostringstream table;
+    std::ostringstream cases;
+    uint32_t block_count = 0;
+    uint32_t word_count = 0;
+    for(uint32_t pc : leaders) {
+        std::vector<rv32i_decode::decoded_insn> insns;
+        uint32_t a = pc;
+        bool more = true;
+        bool uses_mem = false;
+        while(a + 4ull <= size) {
+            rv32i_decode::decoded_insn d = rv32i_decode::predecode(mem.get32(a));
+            d.pc = a;
+            if(!is_translated(d.op)) {
+                more = false;
+                break;
+            }
+            uses_mem |= rv32i_decode::get_spec(static_cast<rv32i_decode::insn_op>(d.op)).fmt == rv32i_decode::fmt_load
+                     || rv32i_decode::get_spec(static_cast<rv32i_decode::insn_op>(d.op)).fmt == rv32i_decode::fmt_stype;
+            insns.push_back(d);
+            a += 4;
+            if(rv32i_hart::is_control(d.op) || leaders.count(a) != 0) {
+                break;
+            }
+        }
+        if(insns.empty()) {
+            continue;
+        }
+
+        std::string name = "b_" + hex::to_hex32(pc);
+        code << "// " << insns.size() << " instructions at " << hex::to_hex0x32(pc) << "\n"
+             << "static bool " << name << "(rv32i_aot::state &s)\n"
+             << "{\n"
+             << "    uint32_t *x = s.regs;\n";
+        if(uses_mem) {
+            code << "    memory &m = *s.mem;\n";
+        }
+        else {
+            code << "    (void)x;\n";
+        }
+        for(uint32_t k = 0; k < insns.size(); k++) {
+            const rv32i_decode::decoded_insn &d = insns[k];
+            code << "\n    // " << hex::to_hex32(d.pc) << ": " << hex::to_hex32(d.insn) << "  "
+                 << rv32i_decode::decode(d.pc, d.insn) << "\n";
+            emit_insn(code, d, k);
+            words << (word_count % 8 == 0 ? "\n    " : " ") << lit(d.insn) << ",";
+            word_count++;
+        }
+        if(!rv32i_hart::is_control(insns.back().op)) {
+            code << "    s.pc = " << lit(a) << ";\n";
+        }
+        code << "    s.left -= " << insns.size() << ";\n"
+             << "    return " << (more ? "true" : "false") << ";\n"
+             << "}\n\n";
+
+        table << "    { " << lit(pc) << ", " << insns.size() << ", " << word_count - insns.size() << " },\n";
+        cases << "            case " << lit(pc) << ":\n"
+              << "                if(s.left < " << insns.size() << " || !" << name << "(s))\n"
+              << "                    return;\n"
+              << "                break;\n";
+        block_count++;
+    }
+    if(block_count == 0) {
+        return false;
+    }
+
+    os << "// Translated by rv32i -a from a " << hex::to_hex0x32(static_cast<uint32_t>(size))
+       << " byte image, entry " << hex::to_hex0x32(entry) << "\n"
+       << "// Build it with the simulator sources, see rv32i_aot.h\n\n"
+       << "#include <cstdint>\n"
+       << "#include \"memory.h\"\n"
+       << "#include \"rv32i_aot.h\"\n\n"
+       << code.str()
+       << "// Every guest pc that starts a block, the rest go to the interpreter\n"
+       << "static void dispatch(rv32i_aot::state &s)\n"
+       << "{\n"
+       << "    for(;;) {\n"
+       << "        switch(s.pc) {\n"
+       << cases.str()
+       << "            default:\n"
+       << "                return;\n"
+       << "        }\n"
+       << "    }\n"
+       << "}\n\n"
+       << "// The guest code each block was translated from\n"
+       << "static const uint32_t words[] = {" << words.str() << "\n};\n\n"
+       << "static const rv32i_aot::block_info blocks[] = {\n" << table.str() << "};\n\n"
+       << "static const rv32i_aot::image translated_image = {\n"
+       << "    blocks, " << block_count << ", words, " << lit(static_cast<uint32_t>(size)) << ", "
+       << rv32i_decode::get_isa() << ", dispatch\n"
+       << "};\n\n"
+       << "int main(int argc, char **argv)\n"
+       << "{\n"
+       << "    return rv32i_aot::main(argc, argv, translated_image);\n"
+       << "}\n";
+    return true;
+}
+
+/*************************************************************************
+Function: check_image
+
+Use: Checks that memory still holds the code an image was translated
+     from, and marks it so that stores into it bump the code epoch.
+
+Arguments:
+1. memory &mem: The guest memory.
+2. const image &img: The translation.
+
+Returns: bool: true if every translated instruction is still there.
+
+ ************************************************************************/
+bool rv32i_aot::check_image(memory &mem, const image &img)
+{
+    for(uint32_t i = 0; i < img.block_count; i++) {
+        const block_info &b = img.blocks[i];
+        if(b.pc + 4ull * b.count > mem.get_size()) {
+            return false;
+        }
+        for(uint32_t k = 0; k < b.count; k++) {
+            if(mem.get32(b.pc + 4 * k) != img.words[b.first + k]) {
+                return false;
+            }
+            mem.mark_code(b.pc + 4 * k);
+        }
+    }
+    return true;
+}
+
+/*************************************************************************
+Function: run
+
+Use: Executes instructions on a hart until it halts or limit instructions
+     have run, through the translated code wherever it covers the pc and
+     through tick() everywhere else.
+
+Arguments:
+1. rv32i_hart &h: The hart, already reset.
+2. const image &img: The translation of what is loaded in its memory.
+3. uint64_t limit: The most instructions to execute, 0 for no limit.
+
+Returns: uint64_t: The number of instructions executed.
+
+Notes: once a store changes the translated code the image is no longer
+     used, and tracing needs the interpreter, so with either show flag
+     set this is just h.run().
+
+ ************************************************************************/
+uint64_t rv32i_aot::run(rv32i_hart &h, const image &img, uint64_t limit)
+{
+    if(h.show_instructions || h.show_registers) {
+        return h.run(limit);
+    }
+
+    uint64_t start = h.insn_counter;
+    state s;
+    s.regs = h.regs.data();
+    s.mem = &h.mem;
+    s.size = h.mem.get_size();
+    s.epoch = h.mem.get_code_epoch();
+    bool usable = check_image(h.mem, img);
+    if(!usable) {
+        std::cerr << "Translated code does not match memory, interpreting" << std::endl;
+    }
+
+    while(!h.halt && (limit == 0 || h.insn_counter - start < limit)) {
+        if(usable && s.epoch != h.mem.get_code_epoch()) {
+            usable = check_image(h.mem, img);
+            s.epoch = h.mem.get_code_epoch();
+        }
+        if(usable) {
+            s.pc = h.pc;
+            s.left = limit == 0 ? UINT64_MAX : limit - (h.insn_counter - start);
+            uint64_t before = s.left;
+            img.dispatch(s);
+            h.insn_counter += before - s.left;
+            h.pc = s.pc;
+            if(limit != 0 && h.insn_counter - start >= limit) {
+                break;
+            }
+        }
+        h.tick();
+    }
+    return h.insn_counter - start;
+}
+
+/*************************************************************************
+Function: main
+
+Use: The driver of a translated simulator: loads an image, runs it and
+     reports how it ended.
+
+Arguments:
+1. int argc: The number of arguments.
+2. char **argv: [-m hex-mem-size] [-l exec-limit] infile
+3. const image &img: The translation of infile's code.
+
+Returns: int: 0 if the image ran, 1 on a usage error.
+
+ ************************************************************************/
+int rv32i_aot::main(int argc, char **argv, const image &img)
+{
+    uint32_t memory_limit = static_cast<uint32_t>(img.mem_size);
+    uint64_t exec_limit = 0;
+    int opt;
+    while((opt = getopt(argc, argv, "m:l:")) != -1) {
+        std::istringstream iss(optarg);
+        if(opt == 'm') {
+            iss >> std::hex >> memory_limit;
+        }
+        else if(opt == 'l') {
+            iss >> exec_limit;
+        }
+        else {
+            optind = argc;
+            break;
+        }
+    }
+    if(optind >= argc) {
+        std::cerr << "Usage: " << argv[0] << " [-m hex-mem-size] [-l exec-limit] infile" << std::endl;
+        return 1;
+    }
+
+    // the interpreter must decode what the image was translated with
+    rv32i_decode::set_isa(img.isa);
+
+    memory mem(memory_limit);
+    rv32i_hart hart(mem);
+    hart.reset();
+    bool loaded;
+    if(memory::is_elf(argv[optind])) {
+        uint32_t entry;
+        loaded = mem.load_elf(argv[optind], entry);
+        hart.set_pc(entry);
+    }
+    else {
+        loaded = mem.load_file(argv[optind]);
+    }
+    if(!loaded) {
+        return 1;
+    }
+
+    run(hart, img, exec_limit);
+    hart.dump();
+    std::cout << "Execution terminated. Reason: " << hart.get_halt_reason() << std::endl;
+    std::cout << hart.get_insn_counter() << " instructions executed" << std::endl;
+    return 0;
+}
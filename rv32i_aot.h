@@ -0,0 +1,83 @@
+//*************************************************************************
+// Ryan Scaglione
+// z1996413
+// CSCI463 - PE1
+//
+// I certify that this is my own work, and where applicable an extension
+// of the starter code for the assignment
+//
+//*************************************************************************
+
+/*************************************************************************
+Class: rv32i_aot
+
+Use: Ahead of time translation of a loaded image to C++. translate()
+     finds the code reachable from the entry point and writes one function
+     per basic block plus a dispatcher that maps a guest pc to its block.
+     Compiling that file together with the simulator sources gives a
+     simulator specialized for the image:
+
+         rv32i -m 10000 -a image.cpp image.bin
+         g++ -O2 image.cpp rv32i_aot.cpp rv32i_hart.cpp rv32i_jit.cpp \
+             rv32i_decode.cpp registerfile.cpp memory.cpp hex.cpp
+
+     run() drives the translated code, handing anything it does not cover
+     (indirect jumps to unknown targets, system and CSR instructions,
+     out of range accesses) to the interpreter one instruction at a time.
+
+*************************************************************************/
+
+#ifndef RV32I_AOT_H
+#define RV32I_AOT_H
+
+#include <cstdint>
+#include <iostream>
+
+#include "memory.h"
+#include "rv32i_hart.h"
+
+class rv32i_aot
+{
+public:
+    // What translated code works on
+    struct state
+    {
+        uint32_t *regs;     // guest x0..x31, x0 is never written
+        memory *mem;
+        uint64_t size;      // every access is range checked against this
+        uint64_t epoch;     // memory code epoch the image was checked at
+        uint64_t left;      // instructions that may still be run
+        uint32_t pc;        // where the guest goes next
+    };
+
+    typedef void (*dispatch_fn)(state &s);
+
+    // The guest code one translated block was made from
+    struct block_info
+    {
+        uint32_t pc;
+        uint32_t count;     // instructions, taken from words[first]
+        uint32_t first;
+    };
+
+    // Everything a translation defines, emitted as rv32i_aot_image
+    struct image
+    {
+        const block_info *blocks;
+        uint32_t block_count;
+        const uint32_t *words;
+        uint64_t mem_size;  // the memory size it was translated with
+        uint32_t isa;       // the rv32i_decode::set_isa() extensions it was translated with
+        dispatch_fn dispatch;
+    };
+
+    static bool translate(const memory &mem, uint32_t entry, std::ostream &os);
+    static uint64_t run(rv32i_hart &h, const image &img, uint64_t limit = 0);
+    static int main(int argc, char **argv, const image &img);
+
+private:
+    static bool check_image(memory &mem, const image &img);
+    static bool is_translated(uint8_t op);
+};
+
+#endif // RV32I_AOT_H
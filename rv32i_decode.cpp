@@ -225,384 +225,347 @@ int32_t rv32i_decode::get_imm_j(uint32_t insn)
 }
 
 /**********************************************************************
-Function: decode
+The spec table, indexed by insn_op. Entry 0 matches anything and is
+what lookup() returns when no instruction does.
+**********************************************************************/
+static constexpr rv32i_decode::insn_spec specs[] =
+{
+    { "illegal", 0, 0, rv32i_decode::op_illegal, rv32i_decode::fmt_illegal, rv32i_decode::isa_base },
+#define RV32_INSN_SPEC(ext, name, mnemonic, mask, match, fmt) \
+    { mnemonic, mask, match, rv32i_decode::op_##name, rv32i_decode::fmt, rv32i_decode::ext },
+#define RV32_BASE_SPEC(...) RV32_INSN_SPEC(isa_base, __VA_ARGS__)
+#define RV32_ZBA_SPEC(...) RV32_INSN_SPEC(isa_zba, __VA_ARGS__)
+#define RV32_ZBB_SPEC(...) RV32_INSN_SPEC(isa_zbb, __VA_ARGS__)
+    RV32_BASE_INSNS(RV32_BASE_SPEC)
+    RV32_ZBA_INSNS(RV32_ZBA_SPEC)
+    RV32_ZBB_INSNS(RV32_ZBB_SPEC)
+#undef RV32_ZBB_SPEC
+#undef RV32_ZBA_SPEC
+#undef RV32_BASE_SPEC
+#undef RV32_INSN_SPEC
+};
+static_assert(sizeof(specs) / sizeof(specs[0]) == rv32i_decode::op_count,
+              "spec table out of step with insn_op");
+static_assert(rv32i_decode::op_count <= 256, "ops must fit the dispatch table");
+
+// The dispatch key is opcode[6:2], funct3 and funct7, which pins down every
+// instruction except the few (ecall/ebreak) that also look at other bits
+static const uint32_t key_bits = 15;
 
-Use: Decodes the instruction and returns the representation
+/**********************************************************************
+Function: dispatch_key
+
+Use: Packs the opcode, funct3 and funct7 fields into a dispatch index
 
 Arguments:
-1. addr: The address of the instruction
-2. insn: The representation of the instruction
+1. insn: The representation of the instruction
 
-Returns: A string with the disassembled instruction
+Returns: the 15 bit dispatch key
 **********************************************************************/
-string rv32i_decode::decode(uint32_t addr, uint32_t insn)
+static constexpr uint32_t dispatch_key(uint32_t insn)
 {
-    uint32_t opcode = get_opcode(insn);
-    switch (opcode)
+    return ((insn >> 2) & 0x1f) | (((insn >> 12) & 0x7) << 5) | ((insn >> 25) << 8);
+}
+
+struct dispatch_table
+{
+    uint8_t op[1u << key_bits];
+};
+
+/**********************************************************************
+Function: build_dispatch
+
+Use: Builds the dense dispatch table from the spec table at compile time
+
+Arguments: None
+
+Returns: a table giving, for every key, the first spec whose mask and
+match agree with it on the key bits
+
+Notes: specs are laid down last to first so earlier ones win, and each
+one only visits the keys its don't-care bits can reach
+**********************************************************************/
+static constexpr dispatch_table build_dispatch()
+{
+    dispatch_table t = {};
+    const uint32_t all = (1u << key_bits) - 1;
+    for (uint32_t i = rv32i_decode::op_count - 1; i > 0; i--)
     {
-        case opcode_lui:
+        // the low opcode bits are not in the key, lookup() checks them
+        uint32_t care = dispatch_key(specs[i].mask);
+        uint32_t base = dispatch_key(specs[i].match) & care;
+        uint32_t free = all & ~care;
+        uint32_t sub = 0;
+        do
         {
+            t.op[base | sub] = static_cast<uint8_t>(i);
+            sub = (sub - free) & free;
+        } while (sub != 0);
+    }
+    return t;
+}
 
-        
-            return render_lui(insn);
-        }
-        case opcode_auipc:
-        {
-            return render_auipc(insn);
-        }
-        case opcode_jal:
-        {
-            return render_jal(addr, insn);
-        }
-        case opcode_jalr:
-        {
-            return render_jalr(insn);
-        }
-        case opcode_branch:
-        {
-            uint32_t funct3 = get_funct3(insn);
-            switch (funct3)
-            {
-            case funct3_beq:
-            {
-                return render_btype(addr, insn, "beq");
-            }
-                
-            case funct3_bne:
-            {
-                return render_btype(addr, insn, "bne");
-            }
-                
-            case funct3_blt:
-            {
-                return render_btype(addr, insn, "blt");
-            }
-            
-            case funct3_bge:
-            {
-                return render_btype(addr, insn, "bge");
-            }
-                
-            case funct3_bltu:
-            {
-                return render_btype(addr, insn, "bltu");
-            }
-                
-            case funct3_bgeu:
-            {
-                return render_btype(addr, insn, "bgeu");
-            }
-                
-            default:
-            {
-                return render_illegal_insn();
-            }
-                
-            }
-        }
-        case opcode_load:
-        {
-            uint32_t funct3 = get_funct3(insn);
-            switch (funct3)
-            {
-            case funct3_lb:
-            {
-                return render_itype_load(insn, "lb");
-            }
-                
-            case funct3_lh:
-            {
-                return render_itype_load(insn, "lh");
-            }
-                
-            case funct3_lw:
-            {
-                return render_itype_load(insn, "lw");
-            }
-                
-            case funct3_lbu:
-            {
-                return render_itype_load(insn, "lbu");
-            }
-                
-            case funct3_lhu:
-            {
-                return render_itype_load(insn, "lhu");
-            }
-                
-            default:
-            {
-                return render_illegal_insn();
-            }
-                
-            }
-        }
-        case opcode_store:
-        {
-            uint32_t funct3 = get_funct3(insn);
-            switch (funct3)
-            {
-                case funct3_sb:
-                {
-                    return render_stype(insn, "sb");
-                }
-            
-                case funct3_sh:
-                {
-                    return render_stype(insn, "sh");
-                }
-                
-                case funct3_sw:
-                {
-                    return render_stype(insn, "sw");
-                }
-                    
-                default:
-                {
-                    return render_illegal_insn();
-                }
-                    
-            }
-        }
-        case opcode_alu_imm:
-        {
-            uint32_t funct3 = get_funct3(insn);
-            int32_t imm_i = get_imm_i(insn);
-            switch (funct3)
-            {
-                case funct3_addi:
-                {
-                    return render_itype_alu(insn, "addi", imm_i);
-                }
-                case funct3_slti:
-                {
-                    return render_itype_alu(insn, "slti", imm_i);
-                }
-                case funct3_sltiu:
-                {
-                    return render_itype_alu(insn, "sltiu", imm_i);
-                }
-                
-                case funct3_xori:
-                {
-                    return render_itype_alu(insn, "xori", imm_i);
-                }
-                
-                case funct3_ori:
-                {
-                    return render_itype_alu(insn, "ori", imm_i);
-                }
-                
-                case funct3_andi:
-                {
-                    return render_itype_alu(insn, "andi", imm_i);
-                }
-                
-                case funct3_slli:
-                {
-                    if (get_funct7(insn) == 0b0000000)
-                    {
-                        uint32_t shamt = insn >> 20 & 0x1f;
-                        return render_itype_alu(insn, "slli", shamt);
-                    }
-                    else
-                    { 
-                        return render_illegal_insn();
-                    }
-                }
-                case funct3_srli_srai:
-                {
-                    uint32_t shamt = insn >> 20 & 0x1f;
-                    uint32_t funct7 = get_funct7(insn);
-                    if (funct7 == 0b0000000)
-                    {
-                        return render_itype_alu(insn, "srli", shamt);
-                    }
-                    else if (funct7 == 0b0100000)
-                    {
-                        return render_itype_alu(insn, "srai", shamt);
-                    }
-                    else
-                    {
-                        return render_illegal_insn();
-                    }
-                    
-                }
-                default:
-                {
-                    return render_illegal_insn();
-                }
-            }
-        }
-        case opcode_alu_reg:
+static constexpr dispatch_table dispatch = build_dispatch();
+
+uint32_t rv32i_decode::isa = rv32i_decode::isa_base;
+
+/**********************************************************************
+Function: set_isa
+
+Use: Picks the optional extensions the decoder recognizes
+
+Arguments:
+1. ext: isa_ext bits or'ed together, isa_base for none of them
+
+Returns: void
+
+Notes: instructions of an extension that is off decode as illegal, in
+the disassembly and in the hart alike
+**********************************************************************/
+void rv32i_decode::set_isa(uint32_t ext)
+{
+    isa = ext & isa_all;
+}
+
+/**********************************************************************
+Function: get_isa
+
+Use: Returns the optional extensions the decoder recognizes
+
+Arguments: None
+
+Returns: the isa_ext bits set by set_isa()
+**********************************************************************/
+uint32_t rv32i_decode::get_isa()
+{
+    return isa;
+}
+
+/**********************************************************************
+Function: lookup
+
+Use: Finds the spec an instruction matches
+
+Arguments:
+1. insn: The representation of the instruction
+
+Returns: the matching spec, or the illegal spec if there is none
+**********************************************************************/
+const rv32i_decode::insn_spec &rv32i_decode::lookup(uint32_t insn)
+{
+    uint32_t i = dispatch.op[dispatch_key(insn)];
+    if ((insn & specs[i].mask) == specs[i].match && (specs[i].ext & ~isa) == 0)
+    {
+        return specs[i];
+    }
+
+    // a key shared by several specs (ecall/ebreak, clz..sext.h) lands on
+    // the first, the rest of them follow it in the table
+    if (i != op_illegal)
+    {
+        for (i++; i < op_count; i++)
         {
-            uint32_t funct3 = get_funct3(insn);
-            uint32_t funct7 = get_funct7(insn);
-            switch (funct3)
+            if ((insn & specs[i].mask) == specs[i].match && (specs[i].ext & ~isa) == 0)
             {
-                case funct3_add_sub:
-                {
-                    if (funct7 == funct7_add)
-                    {
-                        return render_rtype(insn, "add");
-                    }
-                        
-                    else if (funct7 == funct7_sub)
-                    {
-                        return render_rtype(insn, "sub");
-                    }
-                        
-                    else
-                    {
-                        return render_illegal_insn();
-                    }      
-                }
-                    
-                case funct3_sll:
-                {
-                    if (funct7 == funct7_sll)
-                    {
-                        return render_rtype(insn, "sll");
-                    }
-                        
-                    else
-                    {
-                        return render_illegal_insn();
-                    }
-                }
-                
-                case funct3_slt:
-                {
-                    if (funct7 == funct7_slt)
-                    {
-                        return render_rtype(insn, "slt");
-                    }                 
-                    else
-                    {
-                        return render_illegal_insn();
-                    } 
-                }                
-                case funct3_sltu:
-                {
-                    if (funct7 == funct7_sltu)
-                    {
-                        return render_rtype(insn, "sltu");
-                    }                  
-                    else
-                    {
-                        return render_illegal_insn();
-                    }
-                }
-                    
-                case funct3_xor:
-                {
-                    if (funct7 == funct7_xor)
-                    {
-                        return render_rtype(insn, "xor");
-                    } 
-                    else
-                    {
-                        return render_illegal_insn();
-                    }
-                }
-                    
-                case funct3_srl_sra:
-                {
-                    if (funct7 == funct7_srl)
-                    {
-                        return render_rtype(insn, "srl");
-                    }
-                        
-                    else if (funct7 == funct7_sra)
-                    {
-                        return render_rtype(insn, "sra");
-                    }
-                        
-                    else
-                    {
-                        return render_illegal_insn();
-                    }        
-                }
-
-                case funct3_or:
-                {
-                    if (funct7 == funct7_or)
-                    {
-                        return render_rtype(insn, "or");
-                    }
-                    else
-                    {
-                        return render_illegal_insn();
-                    } 
-                }
-                    
-                case funct3_and:
-                {
-                    if (funct7 == funct7_and)
-                    {
-                        return render_rtype(insn, "and");
-                    }   
-                    else
-                    {
-                        return render_illegal_insn();
-                    }
-                }
-                    
-                default:
-                {
-                    return render_illegal_insn();
-                }
+                return specs[i];
             }
         }
-        
+    }
+    return specs[op_illegal];
+}
 
-        case opcode_system:
-        {
-            uint32_t funct3 = get_funct3(insn);
-    
-            if (insn == 0x00000073)
-            {
-                return render_mnemonic("ecall");
-            }
-            else if (insn == 0x00100073)
-            {
-                return render_mnemonic("ebreak");
-            }
-            else if (funct3 == funct3_csrrw)
-            {
-                return render_csrrx(insn, "csrrw");
+/**********************************************************************
+Function: get_spec
 
-            }
-            else if (funct3 == funct3_csrrs)
-            {
-                return render_csrrx(insn, "csrrs");
-            }
-            else if (funct3 == funct3_csrrc)
-            {
-                return render_csrrx(insn, "csrrc");
-            }
-            else if (funct3 == funct3_csrrwi)
-            {
-                return render_csrrxi(insn, "csrrwi");
-            }
-            else if (funct3 == funct3_csrrsi)
-            {
-                return render_csrrxi(insn, "csrrsi");
-            }
-            else if (funct3 == funct3_csrrci)
-            {
-                return render_csrrxi(insn, "csrrci");
-            }
-                return render_illegal_insn();
-        }
+Use: Returns the spec for an operation
+
+Arguments:
+1. op: The operation
+
+Returns: the spec for op
+**********************************************************************/
+const rv32i_decode::insn_spec &rv32i_decode::get_spec(insn_op op)
+{
+    return specs[op];
+}
+
+/**********************************************************************
+The renderer for each format, indexed by insn_format
+**********************************************************************/
+const rv32i_decode::render_fn rv32i_decode::renderers[fmt_count] =
+{
+    // fmt_illegal
+    [](uint32_t, uint32_t, const char *) { return render_illegal_insn(); },
+    // fmt_lui
+    [](uint32_t, uint32_t insn, const char *) { return render_lui(insn); },
+    // fmt_auipc
+    [](uint32_t, uint32_t insn, const char *) { return render_auipc(insn); },
+    // fmt_jal
+    [](uint32_t addr, uint32_t insn, const char *) { return render_jal(addr, insn); },
+    // fmt_jalr
+    [](uint32_t, uint32_t insn, const char *) { return render_jalr(insn); },
+    // fmt_btype
+    [](uint32_t addr, uint32_t insn, const char *m) { return render_btype(addr, insn, m); },
+    // fmt_load
+    [](uint32_t, uint32_t insn, const char *m) { return render_itype_load(insn, m); },
+    // fmt_stype
+    [](uint32_t, uint32_t insn, const char *m) { return render_stype(insn, m); },
+    // fmt_alu_imm
+    [](uint32_t, uint32_t insn, const char *m) { return render_itype_alu(insn, m, get_imm_i(insn)); },
+    // fmt_shift_imm
+    [](uint32_t, uint32_t insn, const char *m) { return render_itype_alu(insn, m, get_rs2(insn)); },
+    // fmt_rtype
+    [](uint32_t, uint32_t insn, const char *m) { return render_rtype(insn, m); },
+    // fmt_mnemonic
+    [](uint32_t, uint32_t, const char *m) { return render_mnemonic(m); },
+    // fmt_csrrx
+    [](uint32_t, uint32_t insn, const char *m) { return render_csrrx(insn, m); },
+    // fmt_csrrxi
+    [](uint32_t, uint32_t insn, const char *m) { return render_csrrxi(insn, m); },
+    // fmt_lr
+    [](uint32_t, uint32_t insn, const char *m) { return render_amo(insn, m); },
+    // fmt_amo
+    [](uint32_t, uint32_t insn, const char *m) { return render_amo(insn, m); },
+    // fmt_unary
+    [](uint32_t, uint32_t insn, const char *m) { return render_unary(insn, m); },
+};
+
+/**********************************************************************
+Function: decode
+
+Use: Decodes the instruction and returns the representation
+
+Arguments:
+1. addr: The address of the instruction
+2. insn: The representation of the instruction
+
+Returns: A string with the disassembled instruction
+**********************************************************************/
+string rv32i_decode::decode(uint32_t addr, uint32_t insn)
+{
+    const insn_spec &s = lookup(insn);
+    return renderers[s.fmt](addr, insn, s.mnemonic);
+}
+
+/**********************************************************************
+Function: predecode
+
+Use: Resolves an instruction to the operation the hart executes for it
+along with its register numbers and final immediate
+
+Arguments:
+1. insn: The representation of the instruction
+
+Returns: the decoded instruction, its pc is left as 0 for the caller
+**********************************************************************/
+rv32i_decode::decoded_insn rv32i_decode::predecode(uint32_t insn)
+{
+    const insn_spec &s = lookup(insn);
+
+    decoded_insn d;
+    d.pc = 0;
+    d.insn = insn;
+    d.op = s.op;
+    d.rd = get_rd(insn);
+    d.rs1 = get_rs1(insn);
+    d.rs2 = get_rs2(insn);
+
+    switch (s.fmt)
+    {
+        case fmt_lui:
+        case fmt_auipc:
+            d.imm = static_cast<int32_t>(static_cast<uint32_t>(get_imm_u(insn)) << 12);
+            break;
+        case fmt_jal:
+            d.imm = get_imm_j(insn);
+            break;
+        case fmt_jalr:
+        case fmt_load:
+        case fmt_alu_imm:
+            d.imm = get_imm_i(insn);
+            break;
+        case fmt_btype:
+            d.imm = get_imm_b(insn);
+            break;
+        case fmt_stype:
+            d.imm = get_imm_s(insn);
+            break;
+        case fmt_shift_imm:
+            d.imm = d.rs2;
+            break;
+        case fmt_csrrx:
+        case fmt_csrrxi:
+            d.imm = (insn >> 20) & 0xfff;
+            break;
         default:
-        {
-            return render_illegal_insn();
-        }
-        
+            d.imm = 0;
+            break;
     }
+    return d;
 }
 
+/**********************************************************************
+Function: fuse
+
+Use: Turns a predecoded instruction and the one after it into a single
+fused entry when they are one of the pairs in op_lui_addi..op_sltu_bnez
+
+Arguments:
+1. d: The predecoded first instruction, rewritten if the pair fuses
+2. next: The representation of the instruction after it
+
+Returns: true if d is now a fused pair
+
+Notes: the pairs are only fused when the second instruction consumes
+the first one's result, so running them together has the same effect
+as running them one after the other
+**********************************************************************/
+bool rv32i_decode::fuse(decoded_insn &d, uint32_t next)
+{
+    decoded_insn n = predecode(next);
+
+    switch (d.op)
+    {
+        case op_lui:
+            if (n.op != op_addi || n.rd != d.rd || n.rs1 != d.rd)
+                return false;
+            d.op = op_lui_addi;
+            break;
+
+        case op_auipc:
+            // through x0 the second one would not see the auipc result
+            if (d.rd == 0 || n.rs1 != d.rd)
+                return false;
+            if (n.op == op_jalr)
+                d.op = op_auipc_jalr;
+            else if (n.op == op_lw)
+                d.op = op_auipc_lw;
+            else
+                return false;
+            d.rs2 = n.rd;
+            break;
+
+        case op_slt:
+        case op_sltu:
+            if (d.rd == 0 || (n.op != op_beq && n.op != op_bne))
+                return false;
+            if (!(n.rs1 == d.rd && n.rs2 == 0) && !(n.rs1 == 0 && n.rs2 == d.rd))
+                return false;
+            if (d.op == op_slt)
+                d.op = (n.op == op_beq) ? op_slt_beqz : op_slt_bnez;
+            else
+                d.op = (n.op == op_beq) ? op_sltu_beqz : op_sltu_bnez;
+            // the branch target, taken relative to the first pc
+            d.imm = 4;
+            break;
+
+        default:
+            return false;
+    }
+
+    d.imm = static_cast<int32_t>(static_cast<uint32_t>(d.imm) + static_cast<uint32_t>(n.imm));
+    return true;
+}
 
 
 /**********************************************************************
@@ -875,8 +838,13 @@ string rv32i_decode::render_mnemonic(const string &mnemonic)
         
 
 
+    // the longer A extension ones still get a space before the operands
     ostringstream stringstream;
     stringstream << left << setw(mnemonic_width) << mnemonic;
+    if (mnemonic.size() >= static_cast<size_t>(mnemonic_width))
+    {
+        stringstream << " ";
+    }
     return stringstream.str();
 }
 
@@ -925,4 +893,56 @@ string rv32i_decode::render_csrrxi(uint32_t insn, const string &mnemonic)
     stringstream << render_mnemonic(mnemonic) << render_reg(rd) << ","
     << hex::to_hex0x12(csr) << "," << immz;
     return stringstream.str();
-}
\ No newline at end of file
+}
+
+/*************************************************************************
+Function: render_amo
+
+Use: Renders an LR, SC or AMO instruction
+
+Arguments: 1:insn, the representation of the instruction
+2: &mnemonic: reference to the string to render
+
+Returns: A formatted string with the mnemonic
+
+Notes: the aq and rl bits are shown as a suffix on the mnemonic, lr.w
+has no rs2 to show
+**********************************************************************/
+string rv32i_decode::render_amo(uint32_t insn, const string &mnemonic)
+{
+    static const char *const suffix[] = { "", ".rl", ".aq", ".aqrl" };
+    uint32_t rd = get_rd(insn);
+    uint32_t rs1 = get_rs1(insn);
+    uint32_t rs2 = get_rs2(insn);
+    ostringstream stringstream;
+
+    stringstream << render_mnemonic(mnemonic + suffix[(insn >> 25) & 3]) << render_reg(rd) << ", ";
+    if (lookup(insn).fmt != fmt_lr)
+    {
+        stringstream << render_reg(rs2) << ", ";
+    }
+    stringstream << "(" << render_reg(rs1) << ")";
+    return stringstream.str();
+}
+
+/**********************************************************************
+Function: render_unary
+
+Use: Renders an instruction with one source register, like clz
+
+Arguments:
+1. insn: The representation of the instruction
+2. mnemonic: The mnemonic string for the instruction
+
+Returns: A string with the disassembled instruction
+**********************************************************************/
+string rv32i_decode::render_unary(uint32_t insn, const string &mnemonic)
+{
+    int rd = get_rd(insn);
+    int rs1 = get_rs1(insn);
+    ostringstream stringstream;
+
+    stringstream << render_mnemonic(mnemonic) << render_reg(rd) << ", "
+    << render_reg(rs1);
+    return stringstream.str();
+}
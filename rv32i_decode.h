@@ -18,6 +18,113 @@
 #include <string>
 #include <cstdint>
 
+/*************************************************************************
+RV32_INSNS is the one list of instructions the simulator knows. Each entry
+is X(name, mnemonic, mask, match, format): the decoder builds its spec and
+dispatch tables from it, and rv32i_hart maps each name to exec_<name>.
+An extension is added by adding its lines here and its exec_ handlers.
+The optional extensions get lists of their own, which lookup() only
+matches while set_isa() has them turned on.
+*************************************************************************/
+#define RV32_INSNS(X) \
+    RV32_BASE_INSNS(X) \
+    RV32_ZBA_INSNS(X) \
+    RV32_ZBB_INSNS(X)
+
+#define RV32_BASE_INSNS(X) \
+    X(lui,    "lui",    0x0000007f, 0x00000037, fmt_lui) \
+    X(auipc,  "auipc",  0x0000007f, 0x00000017, fmt_auipc) \
+    X(jal,    "jal",    0x0000007f, 0x0000006f, fmt_jal) \
+    X(jalr,   "jalr",   0x0000007f, 0x00000067, fmt_jalr) \
+    X(beq,    "beq",    0x0000707f, 0x00000063, fmt_btype) \
+    X(bne,    "bne",    0x0000707f, 0x00001063, fmt_btype) \
+    X(blt,    "blt",    0x0000707f, 0x00004063, fmt_btype) \
+    X(bge,    "bge",    0x0000707f, 0x00005063, fmt_btype) \
+    X(bltu,   "bltu",   0x0000707f, 0x00006063, fmt_btype) \
+    X(bgeu,   "bgeu",   0x0000707f, 0x00007063, fmt_btype) \
+    X(lb,     "lb",     0x0000707f, 0x00000003, fmt_load) \
+    X(lh,     "lh",     0x0000707f, 0x00001003, fmt_load) \
+    X(lw,     "lw",     0x0000707f, 0x00002003, fmt_load) \
+    X(lbu,    "lbu",    0x0000707f, 0x00004003, fmt_load) \
+    X(lhu,    "lhu",    0x0000707f, 0x00005003, fmt_load) \
+    X(sb,     "sb",     0x0000707f, 0x00000023, fmt_stype) \
+    X(sh,     "sh",     0x0000707f, 0x00001023, fmt_stype) \
+    X(sw,     "sw",     0x0000707f, 0x00002023, fmt_stype) \
+    X(addi,   "addi",   0x0000707f, 0x00000013, fmt_alu_imm) \
+    X(slti,   "slti",   0x0000707f, 0x00002013, fmt_alu_imm) \
+    X(sltiu,  "sltiu",  0x0000707f, 0x00003013, fmt_alu_imm) \
+    X(xori,   "xori",   0x0000707f, 0x00004013, fmt_alu_imm) \
+    X(ori,    "ori",    0x0000707f, 0x00006013, fmt_alu_imm) \
+    X(andi,   "andi",   0x0000707f, 0x00007013, fmt_alu_imm) \
+    X(slli,   "slli",   0xfe00707f, 0x00001013, fmt_shift_imm) \
+    X(srli,   "srli",   0xfe00707f, 0x00005013, fmt_shift_imm) \
+    X(srai,   "srai",   0xfe00707f, 0x40005013, fmt_shift_imm) \
+    X(add,    "add",    0xfe00707f, 0x00000033, fmt_rtype) \
+    X(sub,    "sub",    0xfe00707f, 0x40000033, fmt_rtype) \
+    X(sll,    "sll",    0xfe00707f, 0x00001033, fmt_rtype) \
+    X(slt,    "slt",    0xfe00707f, 0x00002033, fmt_rtype) \
+    X(sltu,   "sltu",   0xfe00707f, 0x00003033, fmt_rtype) \
+    X(xor,    "xor",    0xfe00707f, 0x00004033, fmt_rtype) \
+    X(srl,    "srl",    0xfe00707f, 0x00005033, fmt_rtype) \
+    X(sra,    "sra",    0xfe00707f, 0x40005033, fmt_rtype) \
+    X(or,     "or",     0xfe00707f, 0x00006033, fmt_rtype) \
+    X(and,    "and",    0xfe00707f, 0x00007033, fmt_rtype) \
+    X(ecall,  "ecall",  0xffffffff, 0x00000073, fmt_mnemonic) \
+    X(ebreak, "ebreak", 0xffffffff, 0x00100073, fmt_mnemonic) \
+    X(csrrw,  "csrrw",  0x0000707f, 0x00001073, fmt_csrrx) \
+    X(csrrs,  "csrrs",  0x0000707f, 0x00002073, fmt_csrrx) \
+    X(csrrc,  "csrrc",  0x0000707f, 0x00003073, fmt_csrrx) \
+    X(csrrwi, "csrrwi", 0x0000707f, 0x00005073, fmt_csrrxi) \
+    X(csrrsi, "csrrsi", 0x0000707f, 0x00006073, fmt_csrrxi) \
+    X(csrrci, "csrrci", 0x0000707f, 0x00007073, fmt_csrrxi) \
+    X(lr_w,      "lr.w",      0xf9f0707f, 0x1000202f, fmt_lr) \
+    X(sc_w,      "sc.w",      0xf800707f, 0x1800202f, fmt_amo) \
+    X(amoswap_w, "amoswap.w", 0xf800707f, 0x0800202f, fmt_amo) \
+    X(amoadd_w,  "amoadd.w",  0xf800707f, 0x0000202f, fmt_amo) \
+    X(amoxor_w,  "amoxor.w",  0xf800707f, 0x2000202f, fmt_amo) \
+    X(amoand_w,  "amoand.w",  0xf800707f, 0x6000202f, fmt_amo) \
+    X(amoor_w,   "amoor.w",   0xf800707f, 0x4000202f, fmt_amo) \
+    X(amomin_w,  "amomin.w",  0xf800707f, 0x8000202f, fmt_amo) \
+    X(amomax_w,  "amomax.w",  0xf800707f, 0xa000202f, fmt_amo) \
+    X(amominu_w, "amominu.w", 0xf800707f, 0xc000202f, fmt_amo) \
+    X(amomaxu_w, "amomaxu.w", 0xf800707f, 0xe000202f, fmt_amo) \
+    X(mul,    "mul",    0xfe00707f, 0x02000033, fmt_rtype) \
+    X(mulh,   "mulh",   0xfe00707f, 0x02001033, fmt_rtype) \
+    X(mulhsu, "mulhsu", 0xfe00707f, 0x02002033, fmt_rtype) \
+    X(mulhu,  "mulhu",  0xfe00707f, 0x02003033, fmt_rtype) \
+    X(div,    "div",    0xfe00707f, 0x02004033, fmt_rtype) \
+    X(divu,   "divu",   0xfe00707f, 0x02005033, fmt_rtype) \
+    X(rem,    "rem",    0xfe00707f, 0x02006033, fmt_rtype) \
+    X(remu,   "remu",   0xfe00707f, 0x02007033, fmt_rtype)
+
+// Zba, address generation
+#define RV32_ZBA_INSNS(X) \
+    X(sh1add, "sh1add", 0xfe00707f, 0x20002033, fmt_rtype) \
+    X(sh2add, "sh2add", 0xfe00707f, 0x20004033, fmt_rtype) \
+    X(sh3add, "sh3add", 0xfe00707f, 0x20006033, fmt_rtype)
+
+// Zbb, basic bit manipulation. clz..sext.h share one dispatch key and
+// are told apart by their rs2 field
+#define RV32_ZBB_INSNS(X) \
+    X(andn,   "andn",   0xfe00707f, 0x40007033, fmt_rtype) \
+    X(orn,    "orn",    0xfe00707f, 0x40006033, fmt_rtype) \
+    X(xnor,   "xnor",   0xfe00707f, 0x40004033, fmt_rtype) \
+    X(clz,    "clz",    0xfff0707f, 0x60001013, fmt_unary) \
+    X(ctz,    "ctz",    0xfff0707f, 0x60101013, fmt_unary) \
+    X(cpop,   "cpop",   0xfff0707f, 0x60201013, fmt_unary) \
+    X(sext_b, "sext.b", 0xfff0707f, 0x60401013, fmt_unary) \
+    X(sext_h, "sext.h", 0xfff0707f, 0x60501013, fmt_unary) \
+    X(min,    "min",    0xfe00707f, 0x0a004033, fmt_rtype) \
+    X(minu,   "minu",   0xfe00707f, 0x0a005033, fmt_rtype) \
+    X(max,    "max",    0xfe00707f, 0x0a006033, fmt_rtype) \
+    X(maxu,   "maxu",   0xfe00707f, 0x0a007033, fmt_rtype) \
+    X(zext_h, "zext.h", 0xfff0707f, 0x08004033, fmt_unary) \
+    X(rol,    "rol",    0xfe00707f, 0x60001033, fmt_rtype) \
+    X(ror,    "ror",    0xfe00707f, 0x60005033, fmt_rtype) \
+    X(rori,   "rori",   0xfe00707f, 0x60005013, fmt_shift_imm) \
+    X(rev8,   "rev8",   0xfff0707f, 0x69805013, fmt_unary) \
+    X(orc_b,  "orc.b",  0xfff0707f, 0x28705013, fmt_unary)
+
 class rv32i_decode
 {
 public:
@@ -37,6 +144,7 @@ public:
     static const uint32_t opcode_alu_reg = 0x33; 
     static const uint32_t opcode_fence   = 0x0f; 
     static const uint32_t opcode_system  = 0x73; 
+    static const uint32_t opcode_amo     = 0x2f;
 
     //funct3 values branch
      static const uint32_t funct3_beq  = 0x0; 
@@ -98,11 +206,114 @@ public:
     static const uint32_t funct7_sra  = 0x20; 
     static const uint32_t funct7_or   = 0x00; 
     static const uint32_t funct7_and  = 0x00; 
+    static const uint32_t funct7_muldiv = 0x01;
+
+    //funct7 values shift imm
+    static const uint32_t funct7_srli = 0x00;
+    static const uint32_t funct7_srai = 0x20;
+
+    //imm values system
+    static const uint32_t ecall_imm  = 0x000;
+    static const uint32_t ebreak_imm = 0x001;
+
+    //how an instruction's operands are rendered and which immediate it carries
+    enum insn_format : uint8_t
+    {
+        fmt_illegal,
+        fmt_lui,
+        fmt_auipc,
+        fmt_jal,
+        fmt_jalr,
+        fmt_btype,
+        fmt_load,
+        fmt_stype,
+        fmt_alu_imm,
+        fmt_shift_imm,
+        fmt_rtype,
+        fmt_mnemonic,
+        fmt_csrrx,
+        fmt_csrrxi,
+        fmt_lr,
+        fmt_amo,
+        fmt_unary,
+        fmt_count
+    };
+
+    //every operation, generated from RV32_INSNS so that the order matches
+    //the spec table and the hart's handler table
+    enum insn_op : uint8_t
+    {
+        op_illegal,
+#define RV32_INSN_OP(name, mnemonic, mask, match, fmt) op_##name,
+        RV32_INSNS(RV32_INSN_OP)
+#undef RV32_INSN_OP
+        op_count,
+
+        //pairs of instructions that fuse() turns into one entry. lookup()
+        //never returns these, so they have no spec
+        op_lui_addi = op_count,     //lui rd + addi rd, rd: a 32 bit constant
+        op_auipc_jalr,              //auipc t + jalr rd, t: a far call
+        op_auipc_lw,                //auipc t + lw rd, t: a pc relative load
+        op_slt_beqz,                //slt rd + beq/bne testing rd against x0
+        op_slt_bnez,
+        op_sltu_beqz,
+        op_sltu_bnez,
+        op_fused_end
+    };
+
+    //the optional extensions, as bits for set_isa()
+    enum isa_ext : uint8_t
+    {
+        isa_base = 0,       //always there: RV32I, M and A
+        isa_zba  = 1 << 0,
+        isa_zbb  = 1 << 1,
+        isa_all  = isa_zba | isa_zbb
+    };
+
+    //an instruction matches a spec when (insn & mask) == match and the
+    //extension it belongs to is turned on
+    struct insn_spec
+    {
+        const char *mnemonic;
+        uint32_t mask;
+        uint32_t match;
+        insn_op op;
+        insn_format fmt;
+        isa_ext ext;
+    };
+
+    //one predecoded instruction, imm is the final operand value: shifted
+    //for lui/auipc, the shift amount for shift immediates, the CSR number
+    //for the CSR instructions. A fused pair keeps the first instruction's
+    //insn and registers, with imm relative to the first pc and, for the
+    //auipc pairs, the second instruction's rd in rs2
+    struct decoded_insn
+    {
+        uint32_t pc;        //address the entry was decoded for, set by the user
+        uint32_t insn;
+        int32_t imm;
+        uint8_t op;
+        uint8_t rd;
+        uint8_t rs1;
+        uint8_t rs2;
+    };
 
     //Decode function
     static std::string decode(uint32_t addr, uint32_t insn);
+    static decoded_insn predecode(uint32_t insn);
+    static bool fuse(decoded_insn &d, uint32_t next);
+    static const insn_spec &lookup(uint32_t insn);
+    static const insn_spec &get_spec(insn_op op);
+
+    //the extensions lookup() matches, none by default. Set it before any
+    //hart runs, it is shared by every decode in the process
+    static void set_isa(uint32_t ext);
+    static uint32_t get_isa();
 
 private:
+    //the hart reuses the field helpers and renderers for execution and tracing
+    friend class rv32i_hart;
+
     //Helper functions 
     static uint32_t get_opcode(uint32_t insn);
      static uint32_t get_rd(uint32_t insn);
@@ -133,6 +344,14 @@ private:
     static std::string render_mnemonic(const std::string &mnemonic);
     static std::string render_csrrx(uint32_t insn, const std::string &mnemonic);
     static std::string render_csrrxi(uint32_t insn, const std::string &mnemonic);
+    static std::string render_amo(uint32_t insn, const std::string &mnemonic);
+    static std::string render_unary(uint32_t insn, const std::string &mnemonic);
+
+    //the renderer for each format, indexed by insn_format
+    typedef std::string (*render_fn)(uint32_t addr, uint32_t insn, const char *mnemonic);
+    static const render_fn renderers[fmt_count];
+
+    static uint32_t isa;
 
 };
 
@@ -23,26 +23,168 @@ Handles instruction execution, state management, and simulation controls.
 #include "hex.h"
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
 #include <cctype>
 
+// The exec_xxx() helper for each rv32i_decode::insn_op, generated from the
+// same instruction list as the decoder's spec table, one table for each
+// tracing policy
+template<typename Trace>
+struct exec_table
+{
+    typedef void (rv32i_hart::*exec_fn)(uint32_t insn, const Trace &trace);
+
+    static constexpr exec_fn handlers[] =
+    {
+        &rv32i_hart::exec_illegal_insn<Trace>,
+#define RV32_INSN_EXEC(name, mnemonic, mask, match, fmt) &rv32i_hart::exec_##name<Trace>,
+        RV32_INSNS(RV32_INSN_EXEC)
+#undef RV32_INSN_EXEC
+    };
+    static_assert(sizeof(handlers) / sizeof(handlers[0]) == rv32i_decode::op_count,
+                  "handler table out of step with insn_op");
+};
+
+template<typename Trace>
+constexpr typename exec_table<Trace>::exec_fn exec_table<Trace>::handlers[];
+
+/*************************************************************************
+Function: mulh, mulhsu, mulhu, div, divu, rem, remu
+
+Use: The RV32M results every core shares, so the traced, straight and
+     threaded paths cannot drift apart.
+
+Arguments:
+1. uint32_t a: The value of rs1.
+2. uint32_t b: The value of rs2.
+
+Returns: uint32_t: The value written to rd.
+
+Notes: RV32M division never traps. Dividing by zero gives all ones for
+     the quotient and the dividend for the remainder, and INT_MIN / -1
+     gives INT_MIN with a remainder of 0, where the host would fault.
+
+ ************************************************************************/
+static inline uint32_t m_mulh(uint32_t a, uint32_t b)
+{
+    int64_t p = static_cast<int64_t>(static_cast<int32_t>(a)) * static_cast<int32_t>(b);
+    return static_cast<uint32_t>(static_cast<uint64_t>(p) >> 32);
+}
+
+static inline uint32_t m_mulhsu(uint32_t a, uint32_t b)
+{
+    int64_t p = static_cast<int64_t>(static_cast<int32_t>(a)) * static_cast<int64_t>(b);
+    return static_cast<uint32_t>(static_cast<uint64_t>(p) >> 32);
+}
+
+static inline uint32_t m_mulhu(uint32_t a, uint32_t b)
+{
+    return static_cast<uint32_t>((static_cast<uint64_t>(a) * b) >> 32);
+}
+
+static inline uint32_t m_div(uint32_t a, uint32_t b)
+{
+    if(b == 0)
+        return 0xffffffff;
+    if(a == 0x80000000 && b == 0xffffffff)
+        return a;
+    return static_cast<uint32_t>(static_cast<int32_t>(a) / static_cast<int32_t>(b));
+}
+
+static inline uint32_t m_divu(uint32_t a, uint32_t b)
+{
+    return b == 0 ? 0xffffffff : a / b;
+}
+
+static inline uint32_t m_rem(uint32_t a, uint32_t b)
+{
+    if(b == 0)
+        return a;
+    if(a == 0x80000000 && b == 0xffffffff)
+        return 0;
+    return static_cast<uint32_t>(static_cast<int32_t>(a) % static_cast<int32_t>(b));
+}
+
+static inline uint32_t m_remu(uint32_t a, uint32_t b)
+{
+    return b == 0 ? a : a % b;
+}
+
+/*************************************************************************
+Function: zb_clz, zb_ctz, zb_rol, zb_ror, zb_orc_b
+
+Use: The Zbb results that take more than one host operator, shared by
+     every core like the RV32M ones above.
+
+Arguments:
+1. uint32_t a: The value of rs1.
+2. uint32_t b: The value of rs2, or the rotate amount.
+
+Returns: uint32_t: The value written to rd.
+
+Notes: __builtin_clz and __builtin_ctz are undefined for 0, where Zbb
+     wants 32. Rotates only use the low 5 bits of the amount.
+
+ ************************************************************************/
+static inline uint32_t zb_clz(uint32_t a)
+{
+    return a == 0 ? 32 : __builtin_clz(a);
+}
+
+static inline uint32_t zb_ctz(uint32_t a)
+{
+    return a == 0 ? 32 : __builtin_ctz(a);
+}
+
+static inline uint32_t zb_rol(uint32_t a, uint32_t b)
+{
+    b &= 0x1F;
+    return (a << b) | (a >> ((32 - b) & 0x1F));
+}
+
+static inline uint32_t zb_ror(uint32_t a, uint32_t b)
+{
+    b &= 0x1F;
+    return (a >> b) | (a << ((32 - b) & 0x1F));
+}
+
+static inline uint32_t zb_orc_b(uint32_t a)
+{
+    // bit 7 of each byte ends up set when any bit of the byte is, adding
+    // 0x7f to the low 7 bits never carries into the next byte
+    uint32_t t = (((a & 0x7f7f7f7f) + 0x7f7f7f7f) | a) & 0x80808080;
+    return (t >> 7) * 0xff;
+}
+
 // Constructor: Initializes the CSR map and other necessary components
 /*************************************************************************
 Function: rv32i_hart
 
 Use: Constructs a new rv32i_hart object, initializing PC, halt flags, and CSR map.
 
-Arguments: None
+Arguments:
+1. memory &m: The memory the hart fetches from, loads from and stores to.
 
  ************************************************************************/
-rv32i_hart::rv32i_hart()
-    : pc(0), halt(false), halt_reason("none"), decoder(), regs(), mem(),
-      insn_counter(0), mhartid(0), show_instructions(false), show_registers(false)
+rv32i_hart::rv32i_hart(memory &m)
+    : pc(0), halt(false), halt_reason("none"), decoder(), regs(), mem(m),
+      csrs(csr_count, 0), csr_hooks(csr_count, nullptr), time_base(std::chrono::steady_clock::now()),
+      insn_counter(0), mhartid(0), show_instructions(false), show_registers(false),
+      reserved(false), reserved_addr(0), reserved_val(0),
+      icache(icache_size), icache_epoch(0), core(core_threaded),
+      cur_block(nullptr), cur_insn(nullptr), jit_ctx(), use_jit(rv32i_jit::is_supported()), in_jit(false)
 {
-    // Initialize CSR map with standard CSRs (modify as needed)
-    csr_map[0x300] = 0; // mhartid
-    csr_map[0x301] = 0; // mstatus
-    csr_map[0x342] = 0; // mtvec
-    // Add other CSRs as necessary
+    // Every CSR starts out as 0, these are the ones computed on read
+    csr_hooks[csr_cycle] = &counter_hook;
+    csr_hooks[csr_cycleh] = &counter_hook;
+    csr_hooks[csr_instret] = &counter_hook;
+    csr_hooks[csr_instreth] = &counter_hook;
+    csr_hooks[csr_time] = &time_hook;
+    csr_hooks[csr_timeh] = &time_hook;
+    csr_hooks[csr_mhartid] = &mhartid_hook;
+
+    // Value-initialized slots say pc 0, which would hit before reset()
+    flush_icache();
 }
 
 /*************************************************************************
@@ -60,7 +202,58 @@ void rv32i_hart::reset()
     insn_counter = 0;
     halt = false;
     halt_reason = "none";
-    // Optionally reset CSR map if needed
+    reserved = false;
+    time_base = std::chrono::steady_clock::now();
+    flush_icache();
+}
+
+/*************************************************************************
+Function: flush_icache
+
+Use: Drops every predecoded instruction and translated block and syncs
+     with the memory code epoch, so the next fetch of each address
+     decodes it again.
+
+Arguments: None
+
+ ************************************************************************/
+void rv32i_hart::flush_icache()
+{
+    // pc is always word aligned when it is looked up, so 1 never matches
+    for(rv32i_decode::decoded_insn &d : icache) {
+        d.pc = 1;
+    }
+    block_map.clear();
+    blocks.clear();
+    jit.flush();
+    icache_epoch = mem.get_code_epoch();
+}
+
+/*************************************************************************
+Function: icache_fill
+
+Use: Fetches and predecodes the instruction at pc into its cache slot,
+     fusing it with the next one when they make a known pair.
+
+Arguments: None
+
+Returns: const rv32i_decode::decoded_insn &: The filled slot.
+
+Notes: the caller has already checked that pc is aligned and in range.
+     The slot for pc + 4 is left alone, so a jump into the middle of a
+     pair still finds the second instruction on its own.
+
+ ************************************************************************/
+const rv32i_decode::decoded_insn &rv32i_hart::icache_fill()
+{
+    rv32i_decode::decoded_insn &d = icache[(pc >> 2) & (icache_size - 1)];
+    d = rv32i_decode::predecode(mem.get32(pc));
+    d.pc = pc;
+    mem.mark_code(pc);
+    if(pc + 8ull <= mem.get_size() && rv32i_decode::fuse(d, mem.get32(pc + 4))) {
+        mem.mark_code(pc + 4);
+    }
+    return d;
 }
 
 /*************************************************************************
@@ -109,343 +302,117 @@ Arguments:
 void rv32i_hart::set_mhartid(int i)
 {
     mhartid = i;
-    csr_map[0xf14] = mhartid; // Assuming 0xf14 is the CSR for mhartid
 }
 
-/*************************************************************************
-Function: tick
-
-Use: Executes a single instruction cycle. If the hart is halted, returns immediately.
-     Otherwise, fetches, decodes, and executes an instruction, with optional rendering
-     based on flags.
-
-Arguments:
-1. const std::string &hdr: Prefix string for any output.
-
- ************************************************************************/
-void rv32i_hart::tick(const std::string &hdr)
-{
-    if(halt) {
-        return;
-    }
-
-    // Check PC alignment
-    if(pc % 4 != 0) {
-        halt_simulator("PC alignment error");
-        return;
-    }
-
-    // Fetch instruction from memory
-    uint32_t insn = mem.get32(pc);
-
-    // Increment instruction counter
-    insn_counter++;
-
-    // Show registers before execution if flag is set
-    if(show_registers) {
-        dump(hdr);
-    }
-
-    // Show instruction if flag is set
-    if(show_instructions) {
-        std::cout << hex::to_hex32(pc) << ": " 
-                  << hex::to_hex0x32(insn) << " ";
-        exec(insn, &std::cout);
-    }
-    else {
-        exec(insn, nullptr);
-    }
-}
+const rv32i_hart::csr_hook rv32i_hart::counter_hook = { &rv32i_hart::read_counter, &rv32i_hart::write_read_only };
+const rv32i_hart::csr_hook rv32i_hart::time_hook = { &rv32i_hart::read_time, &rv32i_hart::write_read_only };
+const rv32i_hart::csr_hook rv32i_hart::mhartid_hook = { &rv32i_hart::read_mhartid, &rv32i_hart::write_read_only };
 
 /*************************************************************************
-Function: exec
+Function: csr_read
 
-Use: Executes the given RV32I instruction by decoding it and invoking the associated
-     exec_xxx() helper function.
+Use: Reads a CSR, through its hook if it has one.
 
 Arguments:
-1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+1. uint32_t csr: The 12 bit CSR number.
+
+Returns: uint32_t: The CSR's value.
 
  ************************************************************************/
-void rv32i_hart::exec(uint32_t insn, std::ostream* pos)
+inline uint32_t rv32i_hart::csr_read(uint32_t csr) const
 {
-    uint32_t opcode = decoder.get_opcode(insn);
-
-    switch (opcode)
-    {
-        // U-Type Instructions
-        case rv32i_decode::opcode_lui:
-            exec_lui(insn, pos);
-            break;
-
-        case rv32i_decode::opcode_auipc:
-            exec_auipc(insn, pos);
-            break;
-
-        // J-Type Instruction
-        case rv32i_decode::opcode_jal:
-            exec_jal(insn, pos);
-            break;
-
-        // I-Type Instructions
-        case rv32i_decode::opcode_jalr:
-            exec_jalr(insn, pos);
-            break;
-
-        case rv32i_decode::opcode_load:
-            {
-                uint32_t funct3 = decoder.get_funct3(insn);
-                switch(funct3)
-                {
-                    case rv32i_decode::funct3_lb:
-                        exec_lb(insn, pos);
-                        break;
-                    case rv32i_decode::funct3_lh:
-                        exec_lh(insn, pos);
-                        break;
-                    case rv32i_decode::funct3_lw:
-                        exec_lw(insn, pos);
-                        break;
-                    case rv32i_decode::funct3_lbu:
-                        exec_lbu(insn, pos);
-                        break;
-                    case rv32i_decode::funct3_lhu:
-                        exec_lhu(insn, pos);
-                        break;
-                    default:
-                        exec_illegal_insn(insn, pos);
-                        break;
-                }
-            }
-            break;
-
-        case rv32i_decode::opcode_store:
-            {
-                uint32_t funct3 = decoder.get_funct3(insn);
-                switch(funct3)
-                {
-                    case rv32i_decode::funct3_sb:
-                        exec_sb(insn, pos);
-                        break;
-                    case rv32i_decode::funct3_sh:
-                        exec_sh(insn, pos);
-                        break;
-                    case rv32i_decode::funct3_sw:
-                        exec_sw(insn, pos);
-                        break;
-                    default:
-                        exec_illegal_insn(insn, pos);
-                        break;
-                }
-            }
-            break;
-
-        case rv32i_decode::opcode_alu_imm:
-            {
-                uint32_t funct3 = decoder.get_funct3(insn);
-                switch(funct3)
-                {
-                    case rv32i_decode::funct3_addi:
-                        exec_addi(insn, pos);
-                        break;
-                    case rv32i_decode::funct3_slti:
-                        exec_slti(insn, pos);
-                        break;
-                    case rv32i_decode::funct3_sltiu:
-                        exec_sltiu(insn, pos);
-                        break;
-                    case rv32i_decode::funct3_xori:
-                        exec_xori(insn, pos);
-                        break;
-                    case rv32i_decode::funct3_ori:
-                        exec_ori(insn, pos);
-                        break;
-                    case rv32i_decode::funct3_andi:
-                        exec_andi(insn, pos);
-                        break;
-                    case rv32i_decode::funct3_slli:
-                        exec_slli(insn, pos);
-                        break;
-                    case rv32i_decode::funct3_srli_srai:
-                        exec_srli_srai(insn, pos);
-                        break;
-                    default:
-                        exec_illegal_insn(insn, pos);
-                        break;
-                }
-            }
-            break;
-
-        case rv32i_decode::opcode_alu_reg:
-            {
-                uint32_t funct3 = decoder.get_funct3(insn);
-                uint32_t funct7 = decoder.get_funct7(insn);
-                switch(funct3)
-                {
-                    case rv32i_decode::funct3_add_sub:
-                        if(funct7 == rv32i_decode::funct7_add)
-                            exec_add(insn, pos);
-                        else if(funct7 == rv32i_decode::funct7_sub)
-                            exec_sub(insn, pos);
-                        else
-                            exec_illegal_insn(insn, pos);
-                        break;
-                    case rv32i_decode::funct3_sll:
-                        if(funct7 == rv32i_decode::funct7_sll)
-                            exec_sll(insn, pos);
-                        else
-                            exec_illegal_insn(insn, pos);
-                        break;
-                    case rv32i_decode::funct3_slt:
-                        exec_slt(insn, pos);
-                        break;
-                    case rv32i_decode::funct3_sltu:
-                        exec_sltu(insn, pos);
-                        break;
-                    case rv32i_decode::funct3_xor:
-                        exec_xor(insn, pos);
-                        break;
-                    case rv32i_decode::funct3_srl_sra:
-                        if(funct7 == rv32i_decode::funct7_srl)
-                            exec_srl(insn, pos);
-                        else if(funct7 == rv32i_decode::funct7_sra)
-                            exec_sra(insn, pos);
-                        else
-                            exec_illegal_insn(insn, pos);
-                        break;
-                    case rv32i_decode::funct3_or:
-                        exec_or(insn, pos);
-                        break;
-                    case rv32i_decode::funct3_and:
-                        exec_and(insn, pos);
-                        break;
-                    default:
-                        exec_illegal_insn(insn, pos);
-                        break;
-                }
-            }
-            break;
-
-        case rv32i_decode::opcode_system:
-            exec_system(insn, pos);
-            break;
-
-        default:
-            exec_illegal_insn(insn, pos);
-            break;
-    }
-
-    // Increment PC if not modified by instruction
-    // Note: Some instructions like branches and jumps modify PC
-    // Others increment PC by 4. Ensure that all exec_xxx functions handle PC.
+    const csr_hook *h = csr_hooks[csr];
+    return h != nullptr ? (this->*h->read)(csr) : csrs[csr];
 }
 
 /*************************************************************************
-Function: exec_illegal_insn
+Function: csr_write
 
-Use: Handles illegal or unimplemented instructions by halting the simulator
-     with an error message.
+Use: Writes a CSR, through its hook if it has one.
 
 Arguments:
-1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+1. uint32_t csr: The 12 bit CSR number.
+2. uint32_t val: The value to write.
 
  ************************************************************************/
-void rv32i_hart::exec_illegal_insn(uint32_t insn, std::ostream* pos)
+inline void rv32i_hart::csr_write(uint32_t csr, uint32_t val)
 {
-    // Optional rendering
-    if(pos)
-    {
-        std::string s = decoder.render_illegal_insn();
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// Illegal instruction: " << hex::to_hex0x32(insn) << std::endl;
+    const csr_hook *h = csr_hooks[csr];
+    if(h != nullptr) {
+        (this->*h->write)(csr, val);
+    }
+    else {
+        csrs[csr] = val;
     }
-
-    // Halt the simulator with an error
-    halt_simulator("Illegal instruction encountered");
 }
 
 /*************************************************************************
-Function: halt_simulator
+Function: read_counter
 
-Use: Halts the simulator with a specified reason.
+Use: The read hook for cycle, instret and their high halves. Every
+     instruction takes one cycle, so both come from insn_counter, which
+     already counts the instruction doing the read.
 
 Arguments:
-1. const std::string& reason: The reason for halting the simulator.
-
- ************************************************************************/
-void rv32i_hart::halt_simulator(const std::string& reason)
-{
-    halt = true;
-    halt_reason = reason;
-}
-
-/*************************************************************************
-Function: reset
-
-Use: Resets the rv32i_hart object and the registerfile.
+1. uint32_t csr: The 12 bit CSR number.
 
-Arguments: None
+Returns: uint32_t: The low or high half of the count.
 
  ************************************************************************/
-void rv32i_hart::reset()
+uint32_t rv32i_hart::read_counter(uint32_t csr) const
 {
-    pc = 0;
-    regs.reset();
-    insn_counter = 0;
-    halt = false;
-    halt_reason = "none";
-    // Optionally reset CSR map if needed
+    // The high halves are the low ones plus 0x80
+    return (csr & 0x80) ? static_cast<uint32_t>(insn_counter >> 32) : static_cast<uint32_t>(insn_counter);
 }
 
 /*************************************************************************
-Function: dump
+Function: read_time
 
-Use: Dumps the entire state of the hart. Prefix each line printed by the given hdr
-     string (the default being to not print any prefix.) It will dump the GP-regs
-     and then add a dump of the PC register.
+Use: The read hook for time and timeh, microseconds of host monotonic
+     clock since the hart was reset.
 
 Arguments:
-1. const std::string &hdr: Optional header string to prefix each line.
+1. uint32_t csr: The 12 bit CSR number.
+
+Returns: uint32_t: The low or high half of the time.
 
  ************************************************************************/
-void rv32i_hart::dump(const std::string &hdr) const
+uint32_t rv32i_hart::read_time(uint32_t csr) const
 {
-    regs.dump(hdr);
-    std::cout << hdr << "pc " << hex::to_hex32(pc) << std::endl;
+    uint64_t t = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - time_base).count();
+    return (csr & 0x80) ? static_cast<uint32_t>(t >> 32) : static_cast<uint32_t>(t);
 }
 
 /*************************************************************************
-Function: get_insn_counter
+Function: read_mhartid
 
-Use: Accessor for insn_counter. Returns the number of instructions that have been
-     executed by the simulator since the last reset().
+Use: The read hook for mhartid.
 
-Arguments: None
+Arguments:
+1. uint32_t csr: The 12 bit CSR number.
 
-Returns: uint64_t: The instruction counter value.
+Returns: uint32_t: The value given to set_mhartid().
 
  ************************************************************************/
-uint64_t rv32i_hart::get_insn_counter() const
+uint32_t rv32i_hart::read_mhartid(uint32_t) const
 {
-    return insn_counter;
+    return mhartid;
 }
 
 /*************************************************************************
-Function: set_mhartid
+Function: write_read_only
 
-Use: Mutator for mhartid. Sets the ID value to be returned by the csrrs instruction
-     for CSR register number 0xf14.
+Use: The write hook for CSRs that only report hart state, writes to them
+     are dropped.
 
 Arguments:
-1. int i: The hart ID to set.
+1. uint32_t csr: The 12 bit CSR number.
+2. uint32_t val: The value that was written.
 
  ************************************************************************/
-void rv32i_hart::set_mhartid(int i)
+void rv32i_hart::write_read_only(uint32_t, uint32_t)
 {
-    mhartid = i;
-    csr_map[0xf14] = mhartid; // Assuming 0xf14 is the CSR for mhartid
 }
 
 /*************************************************************************
@@ -471,1714 +438,4102 @@ void rv32i_hart::tick(const std::string &hdr)
         return;
     }
 
-    // Fetch instruction from memory
-    uint32_t insn = mem.get32(pc);
-
-    // Increment instruction counter
-    insn_counter++;
-
-    // Show registers before execution if flag is set
-    if(show_registers) {
-        dump(hdr);
+    // Fetches past the end of memory are reported as such rather than
+    // executing whatever get32 hands back for them
+    uint32_t insn_pc = pc;
+    if(!mem.is_guarded() && mem.check_illegal(pc, 4, memory::fault_fetch)) {
+        take_mem_fault(insn_pc);
+        return;
     }
 
-    // Show instruction if flag is set
-    if(show_instructions) {
-        std::cout << hex::to_hex32(pc) << ": " 
-                  << hex::to_hex0x32(insn) << " ";
-        exec(insn, &std::cout);
-    }
-    else {
-        exec(insn, nullptr);
+    // In guarded mode nothing below range checks guest addresses, a bad
+    // fetch, load or store faults on the host and comes back here instead
+    if(!show_instructions && !show_registers) {
+        mem.guarded_call([&]() {
+            // A store into predecoded code since the last tick makes every
+            // entry suspect, self modifying code is rare enough to not care
+            if(icache_epoch != mem.get_code_epoch()) {
+                flush_icache();
+            }
+            const rv32i_decode::decoded_insn *d = &icache[(pc >> 2) & (icache_size - 1)];
+            if(d->pc != pc) {
+                d = &icache_fill();
+            }
+            insn_counter++;
+            if(d->op >= rv32i_decode::op_count) {
+                // A tick is one instruction, so only the first of a pair
+                rv32i_decode::decoded_insn first = rv32i_decode::predecode(d->insn);
+                first.pc = pc;
+                exec_decoded(first);
+            }
+            else {
+                exec_decoded(*d);
+            }
+        });
+        take_mem_fault(insn_pc);
+        return;
     }
+
+    mem.guarded_call([&]() {
+        // Fetch instruction from memory
+        uint32_t insn = mem.get32(pc);
+
+        // Increment instruction counter
+        insn_counter++;
+
+        // Show registers before execution if flag is set
+        if(show_registers) {
+            dump(hdr);
+        }
+
+        // Show instruction if flag is set
+        if(show_instructions) {
+            std::cout << hex::to_hex32(pc) << ": " 
+                      << hex::to_hex0x32(insn) << " ";
+            exec_insn(insn, stream_trace(std::cout));
+        }
+        else {
+            exec_insn(insn, no_trace());
+        }
+    });
+
+    take_mem_fault(insn_pc);
 }
 
 /*************************************************************************
-Function: exec_lui
+Function: run
 
-Use: Executes the LUI (Load Upper Immediate) instruction.
+Use: Executes instructions until the hart halts or limit instructions
+     have been executed, using the core chosen with set_core().
 
 Arguments:
-1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+1. uint64_t limit: The most instructions to execute, 0 for no limit.
 
- ************************************************************************/
-void rv32i_hart::exec_lui(uint32_t insn, std::ostream* pos)
-{
-    uint32_t rd = decoder.get_rd(insn);
-    int32_t imm_u = decoder.get_imm_u(insn); // Immediate is upper 20 bits
+Returns: uint64_t: The number of instructions executed.
 
-    // Set rd to immediate value
-    regs.set(rd, imm_u);
+Notes: tracing needs the rendering in exec(), so with either show flag
+     set every core falls back to calling tick().
 
-    // Optional rendering
-    if(pos)
-    {
-        std::string s = decoder.render_lui(insn);
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// x" << rd << " = " << hex::to_hex0x32(imm_u) << std::endl;
+ ************************************************************************/
+uint64_t rv32i_hart::run(uint64_t limit)
+{
+    uint64_t start = insn_counter;
+    if(core == core_block && !show_instructions && !show_registers) {
+        run_blocks(limit);
+        return insn_counter - start;
     }
-
-    // Increment PC
-    pc += 4;
+#if defined(__GNUC__)
+    if(core == core_threaded && !show_instructions && !show_registers) {
+        run_threaded(limit);
+        return insn_counter - start;
+    }
+#endif
+    while(!halt && (limit == 0 || insn_counter - start < limit)) {
+        tick();
+    }
+    return insn_counter - start;
 }
 
+#if defined(__GNUC__)
 /*************************************************************************
-Function: exec_auipc
+Function: run_threaded
 
-Use: Executes the AUIPC (Add Upper Immediate to PC) instruction.
+Use: The direct threaded core. Executes predecoded instructions out of the
+     icache, each handler jumping straight to the next one's handler with
+     a computed goto instead of returning to a dispatch loop.
 
 Arguments:
-1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+1. uint64_t limit: The most instructions to execute, 0 for no limit.
+
+Notes: the architectural results are the same as tick() with no tracing,
+     including how and where the hart halts and insn_counter.
 
  ************************************************************************/
-void rv32i_hart::exec_auipc(uint32_t insn, std::ostream* pos)
+void rv32i_hart::run_threaded(uint64_t limit)
 {
-    uint32_t rd = decoder.get_rd(insn);
-    int32_t imm_u = decoder.get_imm_u(insn); // Immediate is upper 20 bits
-
-    // Calculate PC + immediate
-    uint32_t result = pc + imm_u;
+    if(halt) {
+        return;
+    }
+    uint64_t left = (limit == 0) ? UINT64_MAX : limit;
+
+    mem.guarded_call([&]() {
+        static void *const handlers[] = {
+            &&do_illegal,
+#define RV32_INSN_LABEL(name, mnemonic, mask, match, fmt) &&do_##name,
+            RV32_INSNS(RV32_INSN_LABEL)
+#undef RV32_INSN_LABEL
+            &&do_lui_addi,
+            &&do_auipc_jalr,
+            &&do_auipc_lw,
+            &&do_slt_beqz,
+            &&do_slt_bnez,
+            &&do_sltu_beqz,
+            &&do_sltu_bnez,
+        };
+        static_assert(sizeof(handlers) / sizeof(handlers[0]) == rv32i_decode::op_fused_end,
+                      "handler table out of step with insn_op");
+
+        const rv32i_decode::decoded_insn *d;
+        uint32_t addr;
+
+        // Every handler ends in DISPATCH, or NEXT for the common pc += 4
+#define DISPATCH() \
+        do { \
+            if(left-- == 0) \
+                return; \
+            d = &icache[(pc >> 2) & (icache_size - 1)]; \
+            if(d->pc != pc) \
+                goto miss; \
+            insn_counter++; \
+            goto *handlers[d->op]; \
+        } while(0)
+#define NEXT() do { pc += 4; DISPATCH(); } while(0)
+#define RS1 regs.get_unchecked(d->rs1)
+#define RS2 regs.get_unchecked(d->rs2)
+#define IMM static_cast<uint32_t>(d->imm)
+#define SET_RD(v) regs.set_unchecked(d->rd, (v))
+#define CHECK_ACCESS(len, kind) \
+        do { \
+            addr = RS1 + IMM; \
+            if(!mem.is_guarded() && mem.check_illegal(addr, len, kind)) { \
+                exec_illegal_insn(d->insn, no_trace()); \
+                return; \
+            } \
+        } while(0)
+#define CHECK_ADDR(len) CHECK_ACCESS(len, memory::fault_read)
+#define CHECK_STORE_ADDR(len) CHECK_ACCESS(len, memory::fault_write)
+#define AFTER_STORE() \
+        do { \
+            if(icache_epoch != mem.get_code_epoch()) \
+                flush_icache(); \
+        } while(0)
+        // A fused pair counts as two, or runs as its first half when
+        // only one more instruction fits in the limit
+#define PAIR() \
+        do { \
+            if(left == 0) \
+                goto split; \
+            left--; \
+            insn_counter++; \
+        } while(0)
+
+        if(icache_epoch != mem.get_code_epoch()) {
+            flush_icache();
+        }
+        DISPATCH();
 
-    // Set rd to result
-    regs.set(rd, result);
+    miss:
+        // Same checks tick() makes before it fetches
+        if(pc % 4 != 0) {
+            halt_simulator("PC alignment error");
+            return;
+        }
+        if(!mem.is_guarded() && mem.check_illegal(pc, 4, memory::fault_fetch)) {
+            return;
+        }
+        d = &icache_fill();
+        insn_counter++;
+        goto *handlers[d->op];
+
+    do_lui:     SET_RD(IMM); NEXT();
+    do_auipc:   SET_RD(pc + IMM); NEXT();
+    do_jal:     SET_RD(pc + 4); pc += IMM; DISPATCH();
+    do_jalr:    addr = (RS1 + IMM) & ~1u; SET_RD(pc + 4); pc = addr; DISPATCH();
+
+    do_beq:     pc += (RS1 == RS2) ? IMM : 4; DISPATCH();
+    do_bne:     pc += (RS1 != RS2) ? IMM : 4; DISPATCH();
+    do_blt:     pc += (static_cast<int32_t>(RS1) < static_cast<int32_t>(RS2)) ? IMM : 4; DISPATCH();
+    do_bge:     pc += (static_cast<int32_t>(RS1) >= static_cast<int32_t>(RS2)) ? IMM : 4; DISPATCH();
+    do_bltu:    pc += (RS1 < RS2) ? IMM : 4; DISPATCH();
+    do_bgeu:    pc += (RS1 >= RS2) ? IMM : 4; DISPATCH();
+
+    do_lb:      CHECK_ADDR(1); SET_RD(mem.get8_sx(addr)); NEXT();
+    do_lh:      CHECK_ADDR(2); SET_RD(mem.get16_sx(addr)); NEXT();
+    do_lw:      CHECK_ADDR(4); SET_RD(mem.get32(addr)); NEXT();
+    do_lbu:     CHECK_ADDR(1); SET_RD(mem.get8(addr)); NEXT();
+    do_lhu:     CHECK_ADDR(2); SET_RD(mem.get16(addr)); NEXT();
+    do_sb:      CHECK_STORE_ADDR(1); mem.set8(addr, RS2 & 0xFF); AFTER_STORE(); NEXT();
+    do_sh:      CHECK_STORE_ADDR(2); mem.set16(addr, RS2 & 0xFFFF); AFTER_STORE(); NEXT();
+    do_sw:      CHECK_STORE_ADDR(4); mem.set32(addr, RS2); AFTER_STORE(); NEXT();
+
+    do_addi:    SET_RD(RS1 + IMM); NEXT();
+    do_slti:    SET_RD(static_cast<int32_t>(RS1) < d->imm); NEXT();
+    do_sltiu:   SET_RD(RS1 < IMM); NEXT();
+    do_xori:    SET_RD(RS1 ^ IMM); NEXT();
+    do_ori:     SET_RD(RS1 | IMM); NEXT();
+    do_andi:    SET_RD(RS1 & IMM); NEXT();
+    do_slli:    SET_RD(RS1 << IMM); NEXT();
+    do_srli:    SET_RD(RS1 >> IMM); NEXT();
+    do_srai:    SET_RD(static_cast<int32_t>(RS1) >> IMM); NEXT();
+
+    do_add:     SET_RD(RS1 + RS2); NEXT();
+    do_sub:     SET_RD(RS1 - RS2); NEXT();
+    do_sll:     SET_RD(RS1 << (RS2 & 0x1F)); NEXT();
+    do_slt:     SET_RD(static_cast<int32_t>(RS1) < static_cast<int32_t>(RS2)); NEXT();
+    do_sltu:    SET_RD(RS1 < RS2); NEXT();
+    do_xor:     SET_RD(RS1 ^ RS2); NEXT();
+    do_srl:     SET_RD(RS1 >> (RS2 & 0x1F)); NEXT();
+    do_sra:     SET_RD(static_cast<int32_t>(RS1) >> (RS2 & 0x1F)); NEXT();
+    do_or:      SET_RD(RS1 | RS2); NEXT();
+    do_and:     SET_RD(RS1 & RS2); NEXT();
+    do_mul:     SET_RD(RS1 * RS2); NEXT();
+    do_mulh:    SET_RD(m_mulh(RS1, RS2)); NEXT();
+    do_mulhsu:  SET_RD(m_mulhsu(RS1, RS2)); NEXT();
+    do_mulhu:   SET_RD(m_mulhu(RS1, RS2)); NEXT();
+    do_div:     SET_RD(m_div(RS1, RS2)); NEXT();
+    do_divu:    SET_RD(m_divu(RS1, RS2)); NEXT();
+    do_rem:     SET_RD(m_rem(RS1, RS2)); NEXT();
+    do_remu:    SET_RD(m_remu(RS1, RS2)); NEXT();
+    do_sh1add:  SET_RD((RS1 << 1) + RS2); NEXT();
+    do_sh2add:  SET_RD((RS1 << 2) + RS2); NEXT();
+    do_sh3add:  SET_RD((RS1 << 3) + RS2); NEXT();
+    do_andn:    SET_RD(RS1 & ~RS2); NEXT();
+    do_orn:     SET_RD(RS1 | ~RS2); NEXT();
+    do_xnor:    SET_RD(~(RS1 ^ RS2)); NEXT();
+    do_clz:     SET_RD(zb_clz(RS1)); NEXT();
+    do_ctz:     SET_RD(zb_ctz(RS1)); NEXT();
+    do_cpop:    SET_RD(__builtin_popcount(RS1)); NEXT();
+    do_sext_b:  SET_RD(static_cast<int32_t>(static_cast<int8_t>(RS1))); NEXT();
+    do_sext_h:  SET_RD(static_cast<int32_t>(static_cast<int16_t>(RS1))); NEXT();
+    do_min:     SET_RD(static_cast<int32_t>(RS1) < static_cast<int32_t>(RS2) ? RS1 : RS2); NEXT();
+    do_minu:    SET_RD(RS1 < RS2 ? RS1 : RS2); NEXT();
+    do_max:     SET_RD(static_cast<int32_t>(RS1) < static_cast<int32_t>(RS2) ? RS2 : RS1); NEXT();
+    do_maxu:    SET_RD(RS1 < RS2 ? RS2 : RS1); NEXT();
+    do_zext_h:  SET_RD(RS1 & 0xFFFF); NEXT();
+    do_rol:     SET_RD(zb_rol(RS1, RS2)); NEXT();
+    do_ror:     SET_RD(zb_ror(RS1, RS2)); NEXT();
+    do_rori:    SET_RD(zb_ror(RS1, IMM)); NEXT();
+    do_rev8:    SET_RD(__builtin_bswap32(RS1)); NEXT();
+    do_orc_b:   SET_RD(zb_orc_b(RS1)); NEXT();
+
+    // Fused pairs, see rv32i_decode::fuse()
+    do_lui_addi:
+        PAIR(); SET_RD(IMM); pc += 8; DISPATCH();
+    do_auipc_jalr:
+        PAIR();
+        SET_RD(pc + (d->insn & 0xfffff000));
+        addr = (pc + IMM) & ~1u;
+        regs.set_unchecked(d->rs2, pc + 8);
+        pc = addr;
+        DISPATCH();
+    do_auipc_lw:
+        // The load is the one that faults, at its own pc
+        PAIR();
+        SET_RD(pc + (d->insn & 0xfffff000));
+        addr = pc + IMM;
+        pc += 4;
+        if(!mem.is_guarded() && mem.check_illegal(addr, 4)) {
+            exec_illegal_insn(mem.get32(pc), no_trace());
+            return;
+        }
+        regs.set_unchecked(d->rs2, mem.get32(addr));
+        NEXT();
+    do_slt_beqz:
+        PAIR(); SET_RD(static_cast<int32_t>(RS1) < static_cast<int32_t>(RS2));
+        pc += regs.get_unchecked(d->rd) ? 8 : IMM; DISPATCH();
+    do_slt_bnez:
+        PAIR(); SET_RD(static_cast<int32_t>(RS1) < static_cast<int32_t>(RS2));
+        pc += regs.get_unchecked(d->rd) ? IMM : 8; DISPATCH();
+    do_sltu_beqz:
+        PAIR(); SET_RD(RS1 < RS2); pc += regs.get_unchecked(d->rd) ? 8 : IMM; DISPATCH();
+    do_sltu_bnez:
+        PAIR(); SET_RD(RS1 < RS2); pc += regs.get_unchecked(d->rd) ? IMM : 8; DISPATCH();
+
+    split:
+        {
+            // lui, auipc, slt and sltu neither halt nor touch memory
+            rv32i_decode::decoded_insn first = rv32i_decode::predecode(d->insn);
+            first.pc = pc;
+            exec_decoded(first);
+        }
+        return;
+
+    // The atomics write memory like the stores do
+    do_lr_w:
+    do_sc_w:
+    do_amoswap_w:
+    do_amoadd_w:
+    do_amoxor_w:
+    do_amoand_w:
+    do_amoor_w:
+    do_amomin_w:
+    do_amomax_w:
+    do_amominu_w:
+    do_amomaxu_w:
+        if(!exec_straight(*d)) {
+            return;
+        }
+        AFTER_STORE();
+        NEXT();
+
+    // The rare ones go through the regular handlers, which move pc
+    // themselves and may halt
+    do_ecall:
+    do_ebreak:
+    do_csrrw:
+    do_csrrs:
+    do_csrrc:
+    do_csrrwi:
+    do_csrrsi:
+    do_csrrci:
+    do_illegal:
+        (this->*exec_table<no_trace>::handlers[d->op])(d->insn, no_trace());
+        if(halt) {
+            return;
+        }
+        DISPATCH();
+
+#undef DISPATCH
+#undef NEXT
+#undef RS1
+#undef RS2
+#undef IMM
+#undef SET_RD
+#undef CHECK_ACCESS
+#undef CHECK_ADDR
+#undef CHECK_STORE_ADDR
+#undef AFTER_STORE
+#undef PAIR
+    });
+
+    take_mem_fault(pc);
+}
+#endif
+
+/*************************************************************************
+Function: find_block
+
+Use: Returns the translated block starting at pc, translating it first
+     if this is the first time pc starts a block.
+
+Arguments: None
+
+Returns: block *: The block, or nullptr if pc cannot be fetched from, in
+     which case the hart has halted or a fetch fault has been recorded.
+
+Notes: a block ends at its first control op or op the JIT cannot
+     emit, after max_block_insns, or where the next fetch would fall off
+     the end of memory. Either kind of op is run by exec_control(), so a
+     translation always covers all of the block but its last one.
+
+ ************************************************************************/
+rv32i_hart::block *rv32i_hart::find_block()
+{
+    std::unordered_map<uint32_t, block *>::iterator it = block_map.find(pc);
+    if(it != block_map.end()) {
+        return it->second;
+    }
+
+    // Same checks tick() makes before it fetches
+    if(pc % 4 != 0) {
+        halt_simulator("PC alignment error");
+        return nullptr;
+    }
+    if(!mem.is_guarded() && mem.check_illegal(pc, 4, memory::fault_fetch)) {
+        return nullptr;
+    }
+
+    blocks.emplace_back();
+    block &b = blocks.back();
+    b.pc = pc;
+    b.ends_in_control = false;
+    b.chain_pc[0] = b.chain_pc[1] = 1;
+    b.chain[0] = b.chain[1] = nullptr;
+    b.heat = 0;
+    b.code = nullptr;
+    b.code_insns = 0;
+
+    uint64_t addr = pc;
+    do {
+        rv32i_decode::decoded_insn d = rv32i_decode::predecode(mem.get32(addr));
+        d.pc = addr;
+        mem.mark_code(addr);
+        b.insns.push_back(d);
+        if(is_control(d.op) || !rv32i_jit::can_translate(d.op)) {
+            b.ends_in_control = true;
+            break;
+        }
+        addr += 4;
+    } while(b.insns.size() < max_block_insns && addr + 4 <= mem.get_size());
+
+    b.straight = b.insns.size() - b.ends_in_control;
+    block_map[pc] = &b;
+    return &b;
+}
+
+/*************************************************************************
+Function: run_translated
+
+Use: Runs a block as translated host code, translating it once it has
+     run jit_threshold times, and finishes whatever the translation
+     leaves to the interpreter.
+
+Arguments:
+1. block *b: The block at pc, which must fit in the run limit.
+
+Returns: uint64_t: The number of instructions executed, 0 if the block
+     has no translation and the caller interprets it.
+
+ ************************************************************************/
+uint64_t rv32i_hart::run_translated(block *b)
+{
+    if(b->code == nullptr) {
+        if(b->heat > jit_threshold || ++b->heat < jit_threshold) {
+            return 0;
+        }
+        // A block that cannot be translated stays too hot to try again
+        b->heat++;
+        uint32_t covered;
+        b->code = jit.compile(b->insns.data(), b->insns.size(), covered);
+        b->code_insns = covered;
+        if(b->code == nullptr) {
+            return 0;
+        }
+    }
+
+    jit_ctx.regs = regs.data();
+    jit_ctx.mem = &mem;
+    jit_ctx.count = 0;
+    in_jit = true;
+    uint32_t status = b->code(&jit_ctx);
+    in_jit = false;
+
+    uint64_t done = jit_ctx.count;
+    insn_counter += done;
+    pc = jit_ctx.next_pc;
+
+    if(status == rv32i_jit::jit_bail) {
+        // The interpreter takes the access, which records the fault
+        insn_counter++;
+        cur_insn = nullptr;
+        exec_decoded(b->insns[done]);
+        done++;
+    }
+    else if(status == rv32i_jit::jit_done && b->code_insns < b->insns.size()) {
+        // The block ends in an op the JIT leaves to the interpreter
+        insn_counter++;
+        exec_control(b->insns[done]);
+        done++;
+    }
+    return done;
+}
+
+/*************************************************************************
+Function: run_blocks
+
+Use: The basic block core. Executes whole translated blocks, following
+     the chain from each block to the next so the translation cache is
+     only searched the first time an edge is taken.
+
+Arguments:
+1. uint64_t limit: The most instructions to execute, 0 for no limit.
+
+Notes: pc and insn_counter are brought up to date once per block. A
+     block is cut short where it halts, where a store hits translated
+     code, or where limit runs out, so the architectural results are
+     the same as tick() with no tracing.
+
+ ************************************************************************/
+void rv32i_hart::run_blocks(uint64_t limit)
+{
+    if(halt) {
+        return;
+    }
+    uint64_t left = (limit == 0) ? UINT64_MAX : limit;
+    cur_block = nullptr;
+
+    bool finished = mem.guarded_call([&]() {
+        block *b = nullptr;
+        while(left != 0) {
+            // Stores into translated code show up here, once per block
+            if(icache_epoch != mem.get_code_epoch()) {
+                flush_icache();
+                b = nullptr;
+            }
+
+            block *next;
+            if(b == nullptr) {
+                cur_insn = nullptr;
+                next = find_block();
+            }
+            else {
+                int edge = (pc == b->pc + 4 * b->insns.size()) ? 0 : 1;
+                if(b->chain_pc[edge] == pc) {
+                    next = b->chain[edge];
+                }
+                else {
+                    cur_insn = nullptr;
+                    next = find_block();
+                    if(next != nullptr) {
+                        b->chain_pc[edge] = pc;
+                        b->chain[edge] = next;
+                    }
+                }
+            }
+            if(next == nullptr) {
+                return;
+            }
+            b = next;
+            cur_block = b;
+
+            // Hot blocks that fit run as host code, when they can
+            if(use_jit && b->insns.size() <= left) {
+                uint64_t done = run_translated(b);
+                if(done != 0) {
+                    left -= done;
+                    if(halt) {
+                        return;
+                    }
+                    continue;
+                }
+            }
+
+            // Only part of the block may fit in what is left
+            uint64_t n = b->straight;
+            bool end = b->ends_in_control;
+            if(n + end > left) {
+                n = left;
+                end = false;
+            }
+
+            const rv32i_decode::decoded_insn *first = b->insns.data();
+            const rv32i_decode::decoded_insn *d = first;
+            const rv32i_decode::decoded_insn *stop = first + n;
+            for(; d != stop; d++) {
+                cur_insn = d;
+                if(!exec_straight(*d)) {
+                    insn_counter += d - first + 1;
+                    pc = d->pc;
+                    return;
+                }
+                // The A extension ops end the block, so only these three
+                // stores can write code before its end
+                if((d->op == rv32i_decode::op_sb || d->op == rv32i_decode::op_sh ||
+                    d->op == rv32i_decode::op_sw) &&
+                   icache_epoch != mem.get_code_epoch()) {
+                    // The rest of the block may be stale
+                    d++;
+                    end = false;
+                    break;
+                }
+            }
+
+            // The control op sees insn_counter count itself, as in tick()
+            uint64_t done = d - first;
+            if(end) {
+                done++;
+                insn_counter += done;
+                cur_insn = nullptr;
+                pc = d->pc;
+                exec_control(*d);
+            }
+            else {
+                insn_counter += done;
+                pc = first->pc + 4 * done;
+            }
+            left -= done;
+            if(halt) {
+                return;
+            }
+        }
+    });
+
+    // A guarded fault abandons the block at the access, which is left as
+    // the current instruction the same way tick() leaves it
+    if(!finished && in_jit) {
+        in_jit = false;
+        cur_insn = cur_block->insns.data() + jit_ctx.count;
+    }
+    if(!finished && cur_insn != nullptr) {
+        insn_counter += cur_insn - cur_block->insns.data() + 1;
+        pc = cur_insn->pc;
+    }
+    take_mem_fault(pc);
+}
+
+/*************************************************************************
+Function: take_mem_fault
+
+Use: Turns an out of range access recorded by memory during the last
+     instruction into a halt, keeping the fault for get_last_fault().
+
+Arguments:
+1. uint32_t insn_pc: The address of the instruction that was executing.
+
+ ************************************************************************/
+void rv32i_hart::take_mem_fault(uint32_t insn_pc)
+{
+    memory::fault f;
+    if(!mem.take_fault(f)) {
+        return;
+    }
+    f.pc = insn_pc;
+    last_fault = f;
+
+    static const char *const kinds[] = { "read", "write", "fetch" };
+    std::string reason = std::string("Memory ") + kinds[f.kind] + " fault at " + hex::to_hex0x32(f.addr);
+    if(f.width != 0) {
+        reason += " (" + std::to_string(f.width) + " bytes)";
+    }
+    halt_simulator(reason + ", pc " + hex::to_hex0x32(f.pc));
+}
+
+/*************************************************************************
+Function: exec
+
+Use: Executes the given RV32I instruction by looking it up in the decoder's
+     spec table and invoking the associated exec_xxx() helper function.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. std::ostream* pos: Optional output stream for logging/disassembly.
+
+ ************************************************************************/
+void rv32i_hart::exec(uint32_t insn, std::ostream* pos)
+{
+    if(pos) {
+        exec_insn(insn, stream_trace(*pos));
+    }
+    else {
+        exec_insn(insn, no_trace());
+    }
+}
+
+/*************************************************************************
+Function: exec_insn
+
+Use: Executes the given RV32I instruction with the exec_xxx() helper
+     instantiated for a tracing policy.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: no_trace, or stream_trace to render it.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_insn(uint32_t insn, const Trace &trace)
+{
+    (this->*exec_table<Trace>::handlers[rv32i_decode::lookup(insn).op])(insn, trace);
+}
+
+/*************************************************************************
+Function: exec_decoded
+
+Use: Executes a predecoded instruction. This is the same work the
+     exec_xxx() helpers do, minus the field extraction and rendering.
+
+Arguments:
+1. const rv32i_decode::decoded_insn &d: The predecoded instruction.
+
+ ************************************************************************/
+void rv32i_hart::exec_decoded(const rv32i_decode::decoded_insn &d)
+{
+    if(is_control(d.op)) {
+        exec_control(d);
+    }
+    else if(exec_straight(d)) {
+        pc += 4;
+    }
+}
+
+/*************************************************************************
+Function: is_control
+
+Use: Tells whether an operation decides the next pc itself. These end a
+     basic block, everything else falls through to pc + 4.
+
+Arguments:
+1. uint8_t op: The rv32i_decode::insn_op to classify.
+
+Returns: bool: true for jumps, branches, system, CSR and illegal ops.
+
+Notes: CSR instructions fall through too, but like the system ones they
+     go through their exec_xxx() helper, which moves pc itself.
+
+ ************************************************************************/
+bool rv32i_hart::is_control(uint8_t op)
+{
+    switch(rv32i_decode::get_spec(static_cast<rv32i_decode::insn_op>(op)).fmt) {
+        case rv32i_decode::fmt_jal:
+        case rv32i_decode::fmt_jalr:
+        case rv32i_decode::fmt_btype:
+        case rv32i_decode::fmt_mnemonic:
+        case rv32i_decode::fmt_csrrx:
+        case rv32i_decode::fmt_csrrxi:
+        case rv32i_decode::fmt_illegal:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/*************************************************************************
+Function: exec_straight
+
+Use: Executes a predecoded instruction that falls through to the next
+     one, without touching pc.
+
+Arguments:
+1. const rv32i_decode::decoded_insn &d: The predecoded instruction, d.pc
+   is the address it was fetched from.
+
+Returns: bool: false if the instruction halted the hart, pc is then left
+     at the instruction like the exec_xxx() helpers leave it.
+
+ ************************************************************************/
+inline bool rv32i_hart::exec_straight(const rv32i_decode::decoded_insn &d)
+{
+    uint32_t rs1 = regs.get_unchecked(d.rs1);
+    uint32_t rs2 = regs.get_unchecked(d.rs2);
+    uint32_t imm = static_cast<uint32_t>(d.imm);
+    uint32_t addr = rs1 + imm;
+
+    switch(d.op)
+    {
+        // U-Type
+        case rv32i_decode::op_lui:
+            regs.set_unchecked(d.rd, imm);
+            return true;
+        case rv32i_decode::op_auipc:
+            regs.set_unchecked(d.rd, d.pc + imm);
+            return true;
+
+        // Loads and stores
+        case rv32i_decode::op_lb:
+        case rv32i_decode::op_lbu:
+        case rv32i_decode::op_sb:
+            if(!mem.is_guarded() &&
+               mem.check_illegal(addr, 1, d.op == rv32i_decode::op_sb ? memory::fault_write : memory::fault_read)) {
+                break;
+            }
+            if(d.op == rv32i_decode::op_lb)
+                regs.set_unchecked(d.rd, mem.get8_sx(addr));
+            else if(d.op == rv32i_decode::op_lbu)
+                regs.set_unchecked(d.rd, mem.get8(addr));
+            else
+                mem.set8(addr, rs2 & 0xFF);
+            return true;
+        case rv32i_decode::op_lh:
+        case rv32i_decode::op_lhu:
+        case rv32i_decode::op_sh:
+            if(!mem.is_guarded() &&
+               mem.check_illegal(addr, 2, d.op == rv32i_decode::op_sh ? memory::fault_write : memory::fault_read)) {
+                break;
+            }
+            if(d.op == rv32i_decode::op_lh)
+                regs.set_unchecked(d.rd, mem.get16_sx(addr));
+            else if(d.op == rv32i_decode::op_lhu)
+                regs.set_unchecked(d.rd, mem.get16(addr));
+            else
+                mem.set16(addr, rs2 & 0xFFFF);
+            return true;
+        case rv32i_decode::op_lw:
+        case rv32i_decode::op_sw:
+            if(!mem.is_guarded() &&
+               mem.check_illegal(addr, 4, d.op == rv32i_decode::op_sw ? memory::fault_write : memory::fault_read)) {
+                break;
+            }
+            if(d.op == rv32i_decode::op_lw)
+                regs.set_unchecked(d.rd, mem.get32(addr));
+            else
+                mem.set32(addr, rs2);
+            return true;
+
+        // ALU immediate
+        case rv32i_decode::op_addi:
+            regs.set_unchecked(d.rd, rs1 + imm);
+            return true;
+        case rv32i_decode::op_slti:
+            regs.set_unchecked(d.rd, static_cast<int32_t>(rs1) < d.imm);
+            return true;
+        case rv32i_decode::op_sltiu:
+            regs.set_unchecked(d.rd, rs1 < imm);
+            return true;
+        case rv32i_decode::op_xori:
+            regs.set_unchecked(d.rd, rs1 ^ imm);
+            return true;
+        case rv32i_decode::op_ori:
+            regs.set_unchecked(d.rd, rs1 | imm);
+            return true;
+        case rv32i_decode::op_andi:
+            regs.set_unchecked(d.rd, rs1 & imm);
+            return true;
+        case rv32i_decode::op_slli:
+            regs.set_unchecked(d.rd, rs1 << imm);
+            return true;
+        case rv32i_decode::op_srli:
+            regs.set_unchecked(d.rd, rs1 >> imm);
+            return true;
+        case rv32i_decode::op_srai:
+            regs.set_unchecked(d.rd, static_cast<int32_t>(rs1) >> imm);
+            return true;
+
+        // ALU register
+        case rv32i_decode::op_add:
+            regs.set_unchecked(d.rd, rs1 + rs2);
+            return true;
+        case rv32i_decode::op_sub:
+            regs.set_unchecked(d.rd, rs1 - rs2);
+            return true;
+        case rv32i_decode::op_sll:
+            regs.set_unchecked(d.rd, rs1 << (rs2 & 0x1F));
+            return true;
+        case rv32i_decode::op_slt:
+            regs.set_unchecked(d.rd, static_cast<int32_t>(rs1) < static_cast<int32_t>(rs2));
+            return true;
+        case rv32i_decode::op_sltu:
+            regs.set_unchecked(d.rd, rs1 < rs2);
+            return true;
+        case rv32i_decode::op_xor:
+            regs.set_unchecked(d.rd, rs1 ^ rs2);
+            return true;
+        case rv32i_decode::op_srl:
+            regs.set_unchecked(d.rd, rs1 >> (rs2 & 0x1F));
+            return true;
+        case rv32i_decode::op_sra:
+            regs.set_unchecked(d.rd, static_cast<int32_t>(rs1) >> (rs2 & 0x1F));
+            return true;
+        case rv32i_decode::op_or:
+            regs.set_unchecked(d.rd, rs1 | rs2);
+            return true;
+        case rv32i_decode::op_and:
+            regs.set_unchecked(d.rd, rs1 & rs2);
+            return true;
+
+        // Multiply and divide
+        case rv32i_decode::op_mul:
+            regs.set_unchecked(d.rd, rs1 * rs2);
+            return true;
+        case rv32i_decode::op_mulh:
+            regs.set_unchecked(d.rd, m_mulh(rs1, rs2));
+            return true;
+        case rv32i_decode::op_mulhsu:
+            regs.set_unchecked(d.rd, m_mulhsu(rs1, rs2));
+            return true;
+        case rv32i_decode::op_mulhu:
+            regs.set_unchecked(d.rd, m_mulhu(rs1, rs2));
+            return true;
+        case rv32i_decode::op_div:
+            regs.set_unchecked(d.rd, m_div(rs1, rs2));
+            return true;
+        case rv32i_decode::op_divu:
+            regs.set_unchecked(d.rd, m_divu(rs1, rs2));
+            return true;
+        case rv32i_decode::op_rem:
+            regs.set_unchecked(d.rd, m_rem(rs1, rs2));
+            return true;
+        case rv32i_decode::op_remu:
+            regs.set_unchecked(d.rd, m_remu(rs1, rs2));
+            return true;
+
+        // Zba and Zbb, which only decode when rv32i_decode::set_isa() has them on
+        case rv32i_decode::op_sh1add:
+            regs.set_unchecked(d.rd, (rs1 << 1) + rs2);
+            return true;
+        case rv32i_decode::op_sh2add:
+            regs.set_unchecked(d.rd, (rs1 << 2) + rs2);
+            return true;
+        case rv32i_decode::op_sh3add:
+            regs.set_unchecked(d.rd, (rs1 << 3) + rs2);
+            return true;
+        case rv32i_decode::op_andn:
+            regs.set_unchecked(d.rd, rs1 & ~rs2);
+            return true;
+        case rv32i_decode::op_orn:
+            regs.set_unchecked(d.rd, rs1 | ~rs2);
+            return true;
+        case rv32i_decode::op_xnor:
+            regs.set_unchecked(d.rd, ~(rs1 ^ rs2));
+            return true;
+        case rv32i_decode::op_clz:
+            regs.set_unchecked(d.rd, zb_clz(rs1));
+            return true;
+        case rv32i_decode::op_ctz:
+            regs.set_unchecked(d.rd, zb_ctz(rs1));
+            return true;
+        case rv32i_decode::op_cpop:
+            regs.set_unchecked(d.rd, __builtin_popcount(rs1));
+            return true;
+        case rv32i_decode::op_sext_b:
+            regs.set_unchecked(d.rd, static_cast<int32_t>(static_cast<int8_t>(rs1)));
+            return true;
+        case rv32i_decode::op_sext_h:
+            regs.set_unchecked(d.rd, static_cast<int32_t>(static_cast<int16_t>(rs1)));
+            return true;
+        case rv32i_decode::op_min:
+            regs.set_unchecked(d.rd, static_cast<int32_t>(rs1) < static_cast<int32_t>(rs2) ? rs1 : rs2);
+            return true;
+        case rv32i_decode::op_minu:
+            regs.set_unchecked(d.rd, rs1 < rs2 ? rs1 : rs2);
+            return true;
+        case rv32i_decode::op_max:
+            regs.set_unchecked(d.rd, static_cast<int32_t>(rs1) < static_cast<int32_t>(rs2) ? rs2 : rs1);
+            return true;
+        case rv32i_decode::op_maxu:
+            regs.set_unchecked(d.rd, rs1 < rs2 ? rs2 : rs1);
+            return true;
+        case rv32i_decode::op_zext_h:
+            regs.set_unchecked(d.rd, rs1 & 0xFFFF);
+            return true;
+        case rv32i_decode::op_rol:
+            regs.set_unchecked(d.rd, zb_rol(rs1, rs2));
+            return true;
+        case rv32i_decode::op_ror:
+            regs.set_unchecked(d.rd, zb_ror(rs1, rs2));
+            return true;
+        case rv32i_decode::op_rori:
+            regs.set_unchecked(d.rd, zb_ror(rs1, imm));
+            return true;
+        case rv32i_decode::op_rev8:
+            regs.set_unchecked(d.rd, __builtin_bswap32(rs1));
+            return true;
+        case rv32i_decode::op_orc_b:
+            regs.set_unchecked(d.rd, zb_orc_b(rs1));
+            return true;
+
+        // Atomics, a misaligned one halts on its own
+        case rv32i_decode::op_lr_w:
+        case rv32i_decode::op_sc_w:
+        case rv32i_decode::op_amoswap_w:
+        case rv32i_decode::op_amoadd_w:
+        case rv32i_decode::op_amoxor_w:
+        case rv32i_decode::op_amoand_w:
+        case rv32i_decode::op_amoor_w:
+        case rv32i_decode::op_amomin_w:
+        case rv32i_decode::op_amomax_w:
+        case rv32i_decode::op_amominu_w:
+        case rv32i_decode::op_amomaxu_w:
+            if(exec_atomic(d)) {
+                return true;
+            }
+            if(halt) {
+                return false;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    // An out of range access, or a control op that should not be here
+    exec_illegal_insn(d.insn, no_trace());
+    return false;
+}
+
+/*************************************************************************
+Function: exec_atomic
+
+Use: Executes a predecoded LR.W, SC.W or AMO on the host atomics memory
+     provides, so harts on other threads see it happen all at once.
+
+Arguments:
+1. const rv32i_decode::decoded_insn &d: The predecoded instruction.
+
+Returns: bool: false if the address is out of range, which is left for
+     the caller to halt on, or misaligned, which halts here.
+
+Notes: sc.w writes rd = 0 when it stores and 1 when it does not. It only
+     compares values, so a word changed and changed back between the
+     lr.w and the sc.w still lets it store.
+
+ ************************************************************************/
+bool rv32i_hart::exec_atomic(const rv32i_decode::decoded_insn &d)
+{
+    uint32_t addr = regs.get_unchecked(d.rs1);
+    uint32_t val = regs.get_unchecked(d.rs2);
+
+    if(addr & 3) {
+        halt_simulator("Misaligned atomic access at " + hex::to_hex0x32(addr));
+        return false;
+    }
+    memory::fault_kind kind = (d.op == rv32i_decode::op_lr_w) ? memory::fault_read : memory::fault_write;
+    if(!mem.is_guarded() && mem.check_illegal(addr, 4, kind)) {
+        return false;
+    }
+
+    uint32_t result;
+    switch(d.op)
+    {
+        case rv32i_decode::op_lr_w:
+            result = mem.get32_atomic(addr);
+            reserved = true;
+            reserved_addr = addr;
+            reserved_val = result;
+            break;
+        case rv32i_decode::op_sc_w:
+            result = !(reserved && reserved_addr == addr && mem.cmpxchg32(addr, reserved_val, val));
+            reserved = false;
+            break;
+        case rv32i_decode::op_amoswap_w:
+            result = mem.amo32(addr, memory::amo_swap, val);
+            break;
+        case rv32i_decode::op_amoadd_w:
+            result = mem.amo32(addr, memory::amo_add, val);
+            break;
+        case rv32i_decode::op_amoxor_w:
+            result = mem.amo32(addr, memory::amo_xor, val);
+            break;
+        case rv32i_decode::op_amoand_w:
+            result = mem.amo32(addr, memory::amo_and, val);
+            break;
+        case rv32i_decode::op_amoor_w:
+            result = mem.amo32(addr, memory::amo_or, val);
+            break;
+        case rv32i_decode::op_amomin_w:
+            result = mem.amo32(addr, memory::amo_min, val);
+            break;
+        case rv32i_decode::op_amomax_w:
+            result = mem.amo32(addr, memory::amo_max, val);
+            break;
+        case rv32i_decode::op_amominu_w:
+            result = mem.amo32(addr, memory::amo_minu, val);
+            break;
+        default:
+            result = mem.amo32(addr, memory::amo_maxu, val);
+            break;
+    }
+    regs.set_unchecked(d.rd, result);
+    return true;
+}
+
+/*************************************************************************
+Function: exec_control
+
+Use: Executes a predecoded instruction that decides the next pc.
+
+Arguments:
+1. const rv32i_decode::decoded_insn &d: The predecoded instruction, d.pc
+   is the address it was fetched from and equals pc.
+
+ ************************************************************************/
+inline void rv32i_hart::exec_control(const rv32i_decode::decoded_insn &d)
+{
+    uint32_t rs1 = regs.get_unchecked(d.rs1);
+    uint32_t rs2 = regs.get_unchecked(d.rs2);
+    uint32_t imm = static_cast<uint32_t>(d.imm);
+
+    switch(d.op)
+    {
+        // Jumps
+        case rv32i_decode::op_jal:
+            regs.set_unchecked(d.rd, d.pc + 4);
+            pc = d.pc + imm;
+            return;
+        case rv32i_decode::op_jalr:
+            regs.set_unchecked(d.rd, d.pc + 4);
+            pc = (rs1 + imm) & ~1u;
+            return;
+
+        // Branches
+        case rv32i_decode::op_beq:
+            pc = d.pc + ((rs1 == rs2) ? imm : 4);
+            return;
+        case rv32i_decode::op_bne:
+            pc = d.pc + ((rs1 != rs2) ? imm : 4);
+            return;
+        case rv32i_decode::op_blt:
+            pc = d.pc + ((static_cast<int32_t>(rs1) < static_cast<int32_t>(rs2)) ? imm : 4);
+            return;
+        case rv32i_decode::op_bge:
+            pc = d.pc + ((static_cast<int32_t>(rs1) >= static_cast<int32_t>(rs2)) ? imm : 4);
+            return;
+        case rv32i_decode::op_bltu:
+            pc = d.pc + ((rs1 < rs2) ? imm : 4);
+            return;
+        case rv32i_decode::op_bgeu:
+            pc = d.pc + ((rs1 >= rs2) ? imm : 4);
+            return;
+
+        // System, CSR and illegal are rare, they go through the regular
+        // handlers
+        default:
+            (this->*exec_table<no_trace>::handlers[d.op])(d.insn, no_trace());
+            return;
+    }
+}
+
+/*************************************************************************
+Function: exec_illegal_insn
+
+Use: Handles illegal or unimplemented instructions by halting the simulator
+     with an error message.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_illegal_insn(uint32_t insn, const Trace &trace)
+{
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_illegal_insn();
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// Illegal instruction: " << hex::to_hex0x32(insn) << std::endl;
+    });
+
+    // Halt the simulator with an error
+    halt_simulator("Illegal instruction encountered");
+}
+
+/*************************************************************************
+Function: halt_simulator
+
+Use: Halts the simulator with a specified reason.
+
+Arguments:
+1. const std::string& reason: The reason for halting the simulator.
+
+ ************************************************************************/
+void rv32i_hart::halt_simulator(const std::string& reason)
+{
+    halt = true;
+    halt_reason = reason;
+}
+
+/*************************************************************************
+Function: exec_lui
+
+Use: Executes the LUI (Load Upper Immediate) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_lui(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    int32_t imm_u = static_cast<uint32_t>(decoder.get_imm_u(insn)) << 12; // Immediate is upper 20 bits
+
+    // Set rd to immediate value
+    regs.set_unchecked(rd, imm_u);
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_lui(insn);
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = " << hex::to_hex0x32(imm_u) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_auipc
+
+Use: Executes the AUIPC (Add Upper Immediate to PC) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_auipc(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    int32_t imm_u = static_cast<uint32_t>(decoder.get_imm_u(insn)) << 12; // Immediate is upper 20 bits
+
+    // Calculate PC + immediate
+    uint32_t result = pc + imm_u;
+
+    // Set rd to result
+    regs.set_unchecked(rd, result);
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_auipc(insn);
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = PC (" << hex::to_hex32(pc) << ") + " 
+           << hex::to_hex0x32(imm_u) << " = " << hex::to_hex32(result) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_jal
+
+Use: Executes the JAL (Jump and Link) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_jal(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    int32_t imm_j = decoder.get_imm_j(insn); // Immediate for JAL
+
+    // Save PC + 4 to rd
+    regs.set_unchecked(rd, pc + 4);
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_jal(pc, insn);
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = PC + 4 (" << hex::to_hex32(pc + 4) 
+           << "), PC += " << hex::to_hex0x32(imm_j) << std::endl;
+    });
+
+    // Jump to PC + immediate
+    pc += imm_j;
+}
+
+/*************************************************************************
+Function: exec_jalr
+
+Use: Executes the JALR (Jump and Link Register) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_jalr(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    int32_t imm_i = decoder.get_imm_i(insn);
+
+    // Calculate target address: (rs1 + imm) & ~1
+    uint32_t target = (regs.get_unchecked(rs1) + imm_i) & ~1;
+
+    // Save PC + 4 to rd
+    regs.set_unchecked(rd, pc + 4);
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_jalr(insn);
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = PC + 4 (" << hex::to_hex32(pc + 4)
+           << "), PC = (x" << rs1 << " + " << hex::to_hex0x32(imm_i) << ") & ~1 ("
+           << hex::to_hex32(target) << ")" << std::endl;
+    });
+
+    // Jump to target address
+    pc = target;
+}
+
+/*************************************************************************
+Function: exec_lb
+
+Use: Executes the LB (Load Byte) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_lb(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    int32_t imm_i = decoder.get_imm_i(insn);
+
+    // Calculate address
+    uint32_t addr = regs.get_unchecked(rs1) + imm_i;
+
+    // Check for illegal memory access
+    if(!mem.is_guarded() && mem.check_illegal(addr, 1))
+    {
+        exec_illegal_insn(insn, trace);
+        return;
+    }
+
+    // Load byte from memory
+    int8_t loaded_byte = mem.get8(addr);
+
+    // Sign-extend to 32 bits
+    int32_t value = static_cast<int32_t>(loaded_byte);
+
+    // Set rd
+    regs.set_unchecked(rd, static_cast<uint32_t>(value));
+
+   
+
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_lh
+
+Use: Executes the LH (Load Halfword) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_lh(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    int32_t imm_i = decoder.get_imm_i(insn);
+
+    // Calculate address
+    uint32_t addr = regs.get_unchecked(rs1) + imm_i;
+
+    // Check for illegal memory access
+    if(!mem.is_guarded() && mem.check_illegal(addr, 2))
+    {
+        exec_illegal_insn(insn, trace);
+        return;
+    }
+
+    // Load halfword from memory
+    int16_t loaded_half = mem.get16(addr);
+
+    // Sign-extend to 32 bits
+    int32_t value = static_cast<int32_t>(loaded_half);
+
+    // Set rd
+    regs.set_unchecked(rd, static_cast<uint32_t>(value));
+
+   
+
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_lw
+
+Use: Executes the LW (Load Word) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_lw(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    int32_t imm_i = decoder.get_imm_i(insn);
+
+    // Calculate address
+    uint32_t addr = regs.get_unchecked(rs1) + imm_i;
+
+    // Check for illegal memory access
+    if(!mem.is_guarded() && mem.check_illegal(addr, 4))
+    {
+        exec_illegal_insn(insn, trace);
+        return;
+    }
+
+    // Load word from memory
+    uint32_t loaded_word = mem.get32(addr);
+
+    // Set rd
+    regs.set_unchecked(rd, loaded_word);
+
+    
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_lbu
+
+Use: Executes the LBU (Load Byte Unsigned) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_lbu(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    int32_t imm_i = decoder.get_imm_i(insn);
+
+    // Calculate address
+    uint32_t addr = regs.get_unchecked(rs1) + imm_i;
+
+    // Check for illegal memory access
+    if(!mem.is_guarded() && mem.check_illegal(addr, 1))
+    {
+        exec_illegal_insn(insn, trace);
+        return;
+    }
+
+    // Load byte from memory
+    uint8_t loaded_byte = mem.get8(addr);
+
+    // Zero-extend to 32 bits
+    uint32_t value = static_cast<uint32_t>(loaded_byte);
+
+    // Set rd
+    regs.set_unchecked(rd, value);
+
+    
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_lhu
+
+Use: Executes the LHU (Load Halfword Unsigned) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_lhu(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    int32_t imm_i = decoder.get_imm_i(insn);
+
+    // Calculate address
+    uint32_t addr = regs.get_unchecked(rs1) + imm_i;
+
+    // Check for illegal memory access
+    if(!mem.is_guarded() && mem.check_illegal(addr, 2))
+    {
+        exec_illegal_insn(insn, trace);
+        return;
+    }
+
+    // Load halfword from memory
+    uint16_t loaded_half = mem.get16(addr);
+
+    // Zero-extend to 32 bits
+    uint32_t value = static_cast<uint32_t>(loaded_half);
+
+    // Set rd
+    regs.set_unchecked(rd, value);
+
+    
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_sb
+
+Use: Executes the SB (Store Byte) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_sb(uint32_t insn, const Trace &trace)
+{
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
+    int32_t imm_s = decoder.get_imm_s(insn);
+
+    // Calculate address
+    uint32_t addr = regs.get_unchecked(rs1) + imm_s;
+
+    // Check for illegal memory access
+    if(!mem.is_guarded() && mem.check_illegal(addr, 1, memory::fault_write))
+    {
+        exec_illegal_insn(insn, trace);
+        return;
+    }
+
+    // Get byte to store
+    uint8_t value = regs.get_unchecked(rs2) & 0xFF;
+
+    // Store byte to memory
+    mem.set8(addr, value);
+
+   
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_sh
+
+Use: Executes the SH (Store Halfword) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_sh(uint32_t insn, const Trace &trace)
+{
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
+    int32_t imm_s = decoder.get_imm_s(insn);
+
+    // Calculate address
+    uint32_t addr = regs.get_unchecked(rs1) + imm_s;
+
+    // Check for illegal memory access
+    if(!mem.is_guarded() && mem.check_illegal(addr, 2, memory::fault_write))
+    {
+        exec_illegal_insn(insn, trace);
+        return;
+    }
+
+    // Get halfword to store
+    uint16_t value = regs.get_unchecked(rs2) & 0xFFFF;
+
+    // Store halfword to memory
+    mem.set16(addr, value);
+
+   
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_sw
+
+Use: Executes the SW (Store Word) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_sw(uint32_t insn, const Trace &trace)
+{
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
+    int32_t imm_s = decoder.get_imm_s(insn);
+
+    // Calculate address
+    uint32_t addr = regs.get_unchecked(rs1) + imm_s;
+
+    // Check for illegal memory access
+    if(!mem.is_guarded() && mem.check_illegal(addr, 4, memory::fault_write))
+    {
+        exec_illegal_insn(insn, trace);
+        return;
+    }
+
+    // Get word to store
+    uint32_t value = regs.get_unchecked(rs2);
+
+    // Store word to memory
+    mem.set32(addr, value);
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_stype(insn, "sw");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// mem[" << hex::to_hex32(addr) << "] = " << hex::to_hex32(value) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_addi
+
+Use: Executes the ADDI (Add Immediate) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_addi(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    int32_t imm_i = decoder.get_imm_i(insn);
+
+    // Perform addition
+    int32_t result = static_cast<int32_t>(regs.get_unchecked(rs1)) + imm_i;
+
+    // Set rd
+    regs.set_unchecked(rd, static_cast<uint32_t>(result));
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_itype_alu(insn, "addi", imm_i);
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = x" << rs1 << " + " << imm_i 
+           << " = " << hex::to_hex32(static_cast<uint32_t>(result)) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_slti
+
+Use: Executes the SLTI (Set Less Than Immediate) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_slti(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    int32_t imm_i = decoder.get_imm_i(insn);
+
+    // Perform set less than
+    int32_t value = (static_cast<int32_t>(regs.get_unchecked(rs1)) < imm_i) ? 1 : 0;
+
+    // Set rd
+    regs.set_unchecked(rd, static_cast<uint32_t>(value));
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_itype_alu(insn, "slti", imm_i);
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = (" << static_cast<int32_t>(regs.get_unchecked(rs1)) 
+           << " < " << imm_i << ") ? 1 : 0 = " << value << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_sltiu
+
+Use: Executes the SLTIU (Set Less Than Immediate Unsigned) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_sltiu(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t imm_i = decoder.get_imm_i(insn); // Treat as unsigned
+
+    // Perform set less than unsigned
+    uint32_t value = (regs.get_unchecked(rs1) < static_cast<uint32_t>(imm_i)) ? 1 : 0;
+
+    // Set rd
+    regs.set_unchecked(rd, value);
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_itype_alu(insn, "sltiu", imm_i);
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = (" << regs.get_unchecked(rs1) 
+           << " < " << hex::to_hex32(imm_i) << ") ? 1 : 0 = " << value << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_xori
+
+Use: Executes the XORI (Exclusive OR Immediate) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_xori(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t imm_i = decoder.get_imm_i(insn);
+
+    // Perform XOR
+    uint32_t result = regs.get_unchecked(rs1) ^ static_cast<uint32_t>(imm_i);
+
+    // Set rd
+    regs.set_unchecked(rd, result);
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_itype_alu(insn, "xori", imm_i);
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = x" << rs1 << " ^ " << hex::to_hex0x32(imm_i) 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_ori
+
+Use: Executes the ORI (OR Immediate) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_ori(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t imm_i = decoder.get_imm_i(insn);
+
+    // Perform OR
+    uint32_t result = regs.get_unchecked(rs1) | static_cast<uint32_t>(imm_i);
+
+    // Set rd
+    regs.set_unchecked(rd, result);
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_itype_alu(insn, "ori", imm_i);
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = x" << rs1 << " | " << hex::to_hex0x32(imm_i) 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_andi
+
+Use: Executes the ANDI (AND Immediate) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_andi(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t imm_i = decoder.get_imm_i(insn);
+
+    // Perform AND
+    uint32_t result = regs.get_unchecked(rs1) & static_cast<uint32_t>(imm_i);
+
+    // Set rd
+    regs.set_unchecked(rd, result);
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_itype_alu(insn, "andi", imm_i);
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = x" << rs1 << " & " << hex::to_hex0x32(imm_i) 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_slli
+
+Use: Executes the SLLI (Shift Left Logical Immediate) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_slli(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t shamt = decoder.get_rs2(insn); // Shift amount [24:20]
+
+    // Perform shift left logical
+    uint32_t result = regs.get_unchecked(rs1) << shamt;
+
+    // Set rd
+    regs.set_unchecked(rd, result);
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_itype_alu(insn, "slli", shamt);
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = x" << rs1 << " << " << shamt 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_srli
+
+Use: Executes the SRLI (Shift Right Logical Immediate) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_srli(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t shamt = decoder.get_rs2(insn); // Shift amount [24:20]
+
+    // Perform shift right logical
+    uint32_t result = regs.get_unchecked(rs1) >> shamt;
+
+    // Set rd
+    regs.set_unchecked(rd, result);
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_itype_alu(insn, "srli", shamt);
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = x" << rs1 << " >> " << shamt 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_srai
+
+Use: Executes the SRAI (Shift Right Arithmetic Immediate) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_srai(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t shamt = decoder.get_rs2(insn); // Shift amount [24:20]
+
+    // Perform shift right arithmetic
+    int32_t value = static_cast<int32_t>(regs.get_unchecked(rs1));
+    int32_t result = value >> shamt;
+
+    // Set rd
+    regs.set_unchecked(rd, static_cast<uint32_t>(result));
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_itype_alu(insn, "srai", shamt);
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = x" << rs1 << " >> " << shamt 
+           << " = " << hex::to_hex32(static_cast<uint32_t>(result)) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_add
+
+Use: Executes the ADD (Add) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_add(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
+
+    // Perform addition
+    uint32_t result = regs.get_unchecked(rs1) + regs.get_unchecked(rs2);
+
+    // Set rd
+    regs.set_unchecked(rd, result);
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_rtype(insn, "add");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = x" << rs1 << " + x" << rs2 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_sub
+
+Use: Executes the SUB (Subtract) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_sub(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
+
+    // Perform subtraction
+    uint32_t result = regs.get_unchecked(rs1) - regs.get_unchecked(rs2);
+
+    // Set rd
+    regs.set_unchecked(rd, result);
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_rtype(insn, "sub");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = x" << rs1 << " - x" << rs2 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_sll
+
+Use: Executes the SLL (Shift Left Logical) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_sll(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
+
+    // Perform shift left logical
+    uint32_t shamt = regs.get_unchecked(rs2) & 0x1F; // Only lower 5 bits used
+    uint32_t result = regs.get_unchecked(rs1) << shamt;
+
+    // Set rd
+    regs.set_unchecked(rd, result);
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_rtype(insn, "sll");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = x" << rs1 << " << " << shamt 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_slt
+
+Use: Executes the SLT (Set Less Than) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_slt(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
+
+    // Perform set less than (signed)
+    int32_t val1 = static_cast<int32_t>(regs.get_unchecked(rs1));
+    int32_t val2 = static_cast<int32_t>(regs.get_unchecked(rs2));
+    uint32_t result = (val1 < val2) ? 1 : 0;
+
+    // Set rd
+    regs.set_unchecked(rd, result);
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_rtype(insn, "slt");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = (" << val1 << " < " << val2 << ") ? 1 : 0 = " 
+           << result << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_sltu
+
+Use: Executes the SLTU (Set Less Than Unsigned) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_sltu(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
+
+    // Perform set less than unsigned
+    uint32_t val1 = regs.get_unchecked(rs1);
+    uint32_t val2 = regs.get_unchecked(rs2);
+    uint32_t result = (val1 < val2) ? 1 : 0;
+
+    // Set rd
+    regs.set_unchecked(rd, result);
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_rtype(insn, "sltu");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = (" << hex::to_hex32(val1) 
+           << " < " << hex::to_hex32(val2) << ") ? 1 : 0 = " << result << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_xor
+
+Use: Executes the XOR (Exclusive OR) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_xor(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
+
+    // Perform XOR
+    uint32_t result = regs.get_unchecked(rs1) ^ regs.get_unchecked(rs2);
+
+    // Set rd
+    regs.set_unchecked(rd, result);
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_rtype(insn, "xor");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = x" << rs1 << " ^ x" << rs2 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_srl
+
+Use: Executes the SRL (Shift Right Logical) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_srl(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
+
+    // Perform shift right logical
+    uint32_t shamt = regs.get_unchecked(rs2) & 0x1F; // Only lower 5 bits
+    uint32_t result = regs.get_unchecked(rs1) >> shamt;
+
+    // Set rd
+    regs.set_unchecked(rd, result);
 
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_auipc(insn);
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// x" << rd << " = PC (" << hex::to_hex32(pc) << ") + " 
-             << hex::to_hex0x32(imm_u) << " = " << hex::to_hex32(result) << std::endl;
+        std::string s = decoder.render_rtype(insn, "srl");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = x" << rs1 << " >> " << shamt 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_sra
+
+Use: Executes the SRA (Shift Right Arithmetic) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_sra(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
+
+    // Perform shift right arithmetic
+    uint32_t shamt = regs.get_unchecked(rs2) & 0x1F; // Only lower 5 bits
+    int32_t value = static_cast<int32_t>(regs.get_unchecked(rs1));
+    int32_t result = value >> shamt;
+
+    // Set rd
+    regs.set_unchecked(rd, static_cast<uint32_t>(result));
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_rtype(insn, "sra");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = x" << rs1 << " >> " << shamt 
+           << " = " << hex::to_hex32(static_cast<uint32_t>(result)) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_or
+
+Use: Executes the OR (Logical OR) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_or(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
+
+    // Perform OR
+    uint32_t result = regs.get_unchecked(rs1) | regs.get_unchecked(rs2);
+
+    // Set rd
+    regs.set_unchecked(rd, result);
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_rtype(insn, "or");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = x" << rs1 << " | x" << rs2 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_and
+
+Use: Executes the AND (Logical AND) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_and(uint32_t insn, const Trace &trace)
+{
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
+
+    // Perform AND
+    uint32_t result = regs.get_unchecked(rs1) & regs.get_unchecked(rs2);
+
+    // Set rd
+    regs.set_unchecked(rd, result);
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_rtype(insn, "and");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = x" << rs1 << " & x" << rs2 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
+}
+
+/*************************************************************************
+Function: exec_beq
+
+Use: Executes the BEQ (Branch if Equal) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_beq(uint32_t insn, const Trace &trace)
+{
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
+    int32_t imm_b = decoder.get_imm_b(insn);
+
+    // Check if registers are equal
+    bool condition = (regs.get_unchecked(rs1) == regs.get_unchecked(rs2));
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_btype(pc, insn, "beq");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// " << (condition ? "branch taken" : "branch not taken") << std::endl;
+    });
+
+    if(condition)
+    {
+        // Branch taken
+        pc += imm_b;
+    }
+    else
+    {
+        // Branch not taken
+        pc += 4;
+    }
+}
+
+/*************************************************************************
+Function: exec_bne
+
+Use: Executes the BNE (Branch if Not Equal) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_bne(uint32_t insn, const Trace &trace)
+{
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
+    int32_t imm_b = decoder.get_imm_b(insn);
+
+    // Check if registers are not equal
+    bool condition = (regs.get_unchecked(rs1) != regs.get_unchecked(rs2));
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_btype(pc, insn, "bne");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// " << (condition ? "branch taken" : "branch not taken") << std::endl;
+    });
+
+    if(condition)
+    {
+        // Branch taken
+        pc += imm_b;
+    }
+    else
+    {
+        // Branch not taken
+        pc += 4;
+    }
+}
+
+/*************************************************************************
+Function: exec_blt
+
+Use: Executes the BLT (Branch if Less Than) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_blt(uint32_t insn, const Trace &trace)
+{
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
+    int32_t imm_b = decoder.get_imm_b(insn);
+
+    // Compare as signed integers
+    int32_t val1 = static_cast<int32_t>(regs.get_unchecked(rs1));
+    int32_t val2 = static_cast<int32_t>(regs.get_unchecked(rs2));
+    bool condition = (val1 < val2);
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_btype(pc, insn, "blt");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// (" << val1 << " < " << val2 << ") = " << condition << std::endl;
+    });
+
+    if(condition)
+    {
+        // Branch taken
+        pc += imm_b;
+    }
+    else
+    {
+        // Branch not taken
+        pc += 4;
+    }
+}
+
+/*************************************************************************
+Function: exec_bge
+
+Use: Executes the BGE (Branch if Greater or Equal) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_bge(uint32_t insn, const Trace &trace)
+{
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
+    int32_t imm_b = decoder.get_imm_b(insn);
+
+    // Compare as signed integers
+    int32_t val1 = static_cast<int32_t>(regs.get_unchecked(rs1));
+    int32_t val2 = static_cast<int32_t>(regs.get_unchecked(rs2));
+    bool condition = (val1 >= val2);
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_btype(pc, insn, "bge");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// (" << val1 << " >= " << val2 << ") = " << condition << std::endl;
+    });
+
+    if(condition)
+    {
+        // Branch taken
+        pc += imm_b;
+    }
+    else
+    {
+        // Branch not taken
+        pc += 4;
+    }
+}
+
+/*************************************************************************
+Function: exec_bltu
+
+Use: Executes the BLTU (Branch if Less Than Unsigned) instruction.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_bltu(uint32_t insn, const Trace &trace)
+{
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
+    int32_t imm_b = decoder.get_imm_b(insn);
+
+    // Compare as unsigned integers
+    uint32_t val1 = regs.get_unchecked(rs1);
+    uint32_t val2 = regs.get_unchecked(rs2);
+    bool condition = (val1 < val2);
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_btype(pc, insn, "bltu");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// (" << hex::to_hex32(val1) << " <U " << hex::to_hex32(val2) 
+           << ") = " << condition << std::endl;
+    });
+
+    if(condition)
+    {
+        // Branch taken
+        pc += imm_b;
+    }
+    else
+    {
+        // Branch not taken
+        pc += 4;
     }
-
-    // Increment PC
-    pc += 4;
 }
 
 /*************************************************************************
-Function: exec_jal
+Function: exec_bgeu
 
-Use: Executes the JAL (Jump and Link) instruction.
+Use: Executes the BGEU (Branch if Greater or Equal Unsigned) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_jal(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_bgeu(uint32_t insn, const Trace &trace)
 {
-    uint32_t rd = decoder.get_rd(insn);
-    int32_t imm_j = decoder.get_imm_j(insn); // Immediate for JAL
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
+    int32_t imm_b = decoder.get_imm_b(insn);
 
-    // Save PC + 4 to rd
-    regs.set(rd, pc + 4);
+    // Compare as unsigned integers
+    uint32_t val1 = regs.get_unchecked(rs1);
+    uint32_t val2 = regs.get_unchecked(rs2);
+    bool condition = (val1 >= val2);
 
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_jal(pc, insn);
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// x" << rd << " = PC + 4 (" << hex::to_hex32(pc + 4) 
-             << "), PC += " << hex::to_hex0x32(imm_j) << std::endl;
-    }
+        std::string s = decoder.render_btype(pc, insn, "bgeu");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// (" << hex::to_hex32(val1) << " >=U " << hex::to_hex32(val2) 
+           << ") = " << condition << std::endl;
+    });
 
-    // Jump to PC + immediate
-    pc += imm_j;
+    if(condition)
+    {
+        // Branch taken
+        pc += imm_b;
+    }
+    else
+    {
+        // Branch not taken
+        pc += 4;
+    }
 }
 
 /*************************************************************************
-Function: exec_jalr
+Function: exec_ecall
 
-Use: Executes the JALR (Jump and Link Register) instruction.
+Use: Executes the ECALL (Environment Call) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_jalr(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_ecall(uint32_t insn, const Trace &trace)
 {
-    uint32_t rd = decoder.get_rd(insn);
-    uint32_t rs1 = decoder.get_rs1(insn);
-    int32_t imm_i = decoder.get_imm_i(insn);
-
-    // Calculate target address: (rs1 + imm) & ~1
-    uint32_t target = (regs.get(rs1) + imm_i) & ~1;
-
-    // Save PC + 4 to rd
-    regs.set(rd, pc + 4);
+    // There is only the one encoding, nothing to take from it
+    (void)insn;
 
-   
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_mnemonic("ecall");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// Environment call" << std::endl;
+    });
 
-    // Jump to target address
-    pc = target;
+    // Define behavior for ECALL, e.g., syscall handling, halt simulation, etc.
+    // For simplicity, we'll halt the simulator
+    halt_simulator("ECALL instruction");
 }
 
 /*************************************************************************
-Function: exec_lb
+Function: exec_ebreak
 
-Use: Executes the LB (Load Byte) instruction.
+Use: Executes the EBREAK (Environment Break) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_lb(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_ebreak(uint32_t insn, const Trace &trace)
 {
-    uint32_t rd = decoder.get_rd(insn);
-    uint32_t rs1 = decoder.get_rs1(insn);
-    int32_t imm_i = decoder.get_imm_i(insn);
+    // There is only the one encoding, nothing to take from it
+    (void)insn;
 
-    // Calculate address
-    uint32_t addr = regs.get(rs1) + imm_i;
-
-    // Check for illegal memory access
-    if(mem.check_illegal(addr, 1))
+    // Optional rendering
+    trace.render([&](std::ostream &os)
     {
-        exec_illegal_insn(insn, pos);
-        return;
-    }
-
-    // Load byte from memory
-    int8_t loaded_byte = mem.get8(addr);
-
-    // Sign-extend to 32 bits
-    int32_t value = static_cast<int32_t>(loaded_byte);
-
-    // Set rd
-    regs.set(rd, static_cast<uint32_t>(value));
-
-   
+        std::string s = decoder.render_mnemonic("ebreak");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// Environment break" << std::endl;
+    });
 
-    // Increment PC
-    pc += 4;
+    // Define behavior for EBREAK, e.g., debug breakpoint, halt simulation, etc.
+    // For simplicity, we'll halt the simulator
+    halt_simulator("EBREAK instruction");
 }
 
 /*************************************************************************
-Function: exec_lh
+Function: exec_csrrx
 
-Use: Executes the LH (Load Halfword) instruction.
+Use: Executes CSR Read/Write, Read/Set, and Read/Clear instructions.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_lh(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_csrrx(uint32_t insn, const Trace &trace)
 {
     uint32_t rd = decoder.get_rd(insn);
     uint32_t rs1 = decoder.get_rs1(insn);
-    int32_t imm_i = decoder.get_imm_i(insn);
+    uint32_t csr = (insn >> 20) & 0xFFF; // CSR address
 
-    // Calculate address
-    uint32_t addr = regs.get(rs1) + imm_i;
+    uint32_t csr_val = csr_read(csr);
+    uint32_t rs1_val = regs.get_unchecked(rs1);
+    uint32_t new_csr_val;
 
-    // Check for illegal memory access
-    if(mem.check_illegal(addr, 2))
+    switch(decoder.get_funct3(insn))
     {
-        exec_illegal_insn(insn, pos);
-        return;
+        case rv32i_decode::funct3_csrrw:
+            // Swap CSR and rs1
+            new_csr_val = rs1_val;
+            break;
+        case rv32i_decode::funct3_csrrs:
+            // Set CSR = CSR | rs1
+            new_csr_val = csr_val | rs1_val;
+            break;
+        case rv32i_decode::funct3_csrrc:
+            // Set CSR = CSR & ~rs1
+            new_csr_val = csr_val & ~rs1_val;
+            break;
+        default:
+            exec_illegal_insn(insn, trace);
+            return;
     }
+    regs.set_unchecked(rd, csr_val);
 
-    // Load halfword from memory
-    int16_t loaded_half = mem.get16(addr);
-
-    // Sign-extend to 32 bits
-    int32_t value = static_cast<int32_t>(loaded_half);
-
-    // Set rd
-    regs.set(rd, static_cast<uint32_t>(value));
+    // Update CSR, set and clear with x0 only read it
+    if(decoder.get_funct3(insn) == rv32i_decode::funct3_csrrw || rs1 != 0) {
+        csr_write(csr, new_csr_val);
+    }
 
-   
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_csrrx(insn, rv32i_decode::lookup(insn).mnemonic);
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = " << hex::to_hex32(csr_val) 
+           << ", CSR[" << hex::to_hex32(csr) << "] = " << hex::to_hex32(new_csr_val) << std::endl;
+    });
 
     // Increment PC
     pc += 4;
 }
 
 /*************************************************************************
-Function: exec_lw
+Function: exec_csrrxi
 
-Use: Executes the LW (Load Word) instruction.
+Use: Executes CSR Read/Write Immediate, Read/Set Immediate, and 
+     Read/Clear Immediate instructions.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_lw(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_csrrxi(uint32_t insn, const Trace &trace)
 {
     uint32_t rd = decoder.get_rd(insn);
-    uint32_t rs1 = decoder.get_rs1(insn);
-    int32_t imm_i = decoder.get_imm_i(insn);
+    uint32_t zimm = decoder.get_rs1(insn); // Zero-extended immediate
+    uint32_t csr = (insn >> 20) & 0xFFF;  // CSR address
 
-    // Calculate address
-    uint32_t addr = regs.get(rs1) + imm_i;
+    uint32_t csr_val = csr_read(csr);
+    uint32_t new_csr_val;
 
-    // Check for illegal memory access
-    if(mem.check_illegal(addr, 4))
+    switch(decoder.get_funct3(insn))
     {
-        exec_illegal_insn(insn, pos);
-        return;
+        case rv32i_decode::funct3_csrrwi:
+            // Swap CSR and zimm (treated as rs1 = zimm)
+            new_csr_val = zimm;
+            break;
+        case rv32i_decode::funct3_csrrsi:
+            // Set CSR = CSR | zimm
+            new_csr_val = csr_val | zimm;
+            break;
+        case rv32i_decode::funct3_csrrci:
+            // Set CSR = CSR & ~zimm
+            new_csr_val = csr_val & ~zimm;
+            break;
+        default:
+            exec_illegal_insn(insn, trace);
+            return;
     }
+    regs.set_unchecked(rd, csr_val);
 
-    // Load word from memory
-    uint32_t loaded_word = mem.get32(addr);
+    // Update CSR, set and clear with 0 only read it
+    if(decoder.get_funct3(insn) == rv32i_decode::funct3_csrrwi || zimm != 0) {
+        csr_write(csr, new_csr_val);
+    }
 
-    // Set rd
-    regs.set(rd, loaded_word);
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_csrrxi(insn, rv32i_decode::lookup(insn).mnemonic);
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = " << hex::to_hex32(csr_val) 
+           << ", CSR[" << hex::to_hex32(csr) << "] = " << hex::to_hex32(new_csr_val) << std::endl;
+    });
 
-    
     // Increment PC
     pc += 4;
 }
 
 /*************************************************************************
-Function: exec_lbu
+Function: exec_csrrw
 
-Use: Executes the LBU (Load Byte Unsigned) instruction.
+Use: Executes the CSR Read/Write instruction by delegating to exec_csrrx.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_lbu(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_csrrw(uint32_t insn, const Trace &trace)
 {
-    uint32_t rd = decoder.get_rd(insn);
-    uint32_t rs1 = decoder.get_rs1(insn);
-    int32_t imm_i = decoder.get_imm_i(insn);
+    // Delegates to exec_csrrx
+    exec_csrrx(insn, trace);
+}
 
-    // Calculate address
-    uint32_t addr = regs.get(rs1) + imm_i;
+/*************************************************************************
+Function: exec_csrrs
 
-    // Check for illegal memory access
-    if(mem.check_illegal(addr, 1))
-    {
-        exec_illegal_insn(insn, pos);
-        return;
-    }
+Use: Executes the CSR Read/Set instruction by delegating to exec_csrrx.
 
-    // Load byte from memory
-    uint8_t loaded_byte = mem.get8(addr);
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
-    // Zero-extend to 32 bits
-    uint32_t value = static_cast<uint32_t>(loaded_byte);
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_csrrs(uint32_t insn, const Trace &trace)
+{
+    // Delegates to exec_csrrx
+    exec_csrrx(insn, trace);
+}
 
-    // Set rd
-    regs.set(rd, value);
+/*************************************************************************
+Function: exec_csrrc
 
-    
-    // Increment PC
-    pc += 4;
+Use: Executes the CSR Read/Clear instruction by delegating to exec_csrrx.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_csrrc(uint32_t insn, const Trace &trace)
+{
+    // Delegates to exec_csrrx
+    exec_csrrx(insn, trace);
 }
 
 /*************************************************************************
-Function: exec_lhu
+Function: exec_csrrwi
 
-Use: Executes the LHU (Load Halfword Unsigned) instruction.
+Use: Executes the CSR Read/Write Immediate instruction by delegating to exec_csrrxi.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_lhu(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_csrrwi(uint32_t insn, const Trace &trace)
 {
-    uint32_t rd = decoder.get_rd(insn);
-    uint32_t rs1 = decoder.get_rs1(insn);
-    int32_t imm_i = decoder.get_imm_i(insn);
+    // Delegates to exec_csrrxi
+    exec_csrrxi(insn, trace);
+}
 
-    // Calculate address
-    uint32_t addr = regs.get(rs1) + imm_i;
+/*************************************************************************
+Function: exec_csrrsi
 
-    // Check for illegal memory access
-    if(mem.check_illegal(addr, 2))
-    {
-        exec_illegal_insn(insn, pos);
-        return;
-    }
+Use: Executes the CSR Read/Set Immediate instruction by delegating to exec_csrrxi.
 
-    // Load halfword from memory
-    uint16_t loaded_half = mem.get16(addr);
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
-    // Zero-extend to 32 bits
-    uint32_t value = static_cast<uint32_t>(loaded_half);
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_csrrsi(uint32_t insn, const Trace &trace)
+{
+    // Delegates to exec_csrrxi
+    exec_csrrxi(insn, trace);
+}
 
-    // Set rd
-    regs.set(rd, value);
+/*************************************************************************
+Function: exec_csrrci
 
-    
-    // Increment PC
-    pc += 4;
+Use: Executes the CSR Read/Clear Immediate instruction by delegating to exec_csrrxi.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_csrrci(uint32_t insn, const Trace &trace)
+{
+    // Delegates to exec_csrrxi
+    exec_csrrxi(insn, trace);
 }
 
 /*************************************************************************
-Function: exec_sb
+Function: exec_amo
 
-Use: Executes the SB (Store Byte) instruction.
+Use: Executes the A extension instructions, LR.W, SC.W and the AMOs.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_sb(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_amo(uint32_t insn, const Trace &trace)
 {
-    uint32_t rs1 = decoder.get_rs1(insn);
-    uint32_t rs2 = decoder.get_rs2(insn);
-    int32_t imm_s = decoder.get_imm_s(insn);
-
-    // Calculate address
-    uint32_t addr = regs.get(rs1) + imm_s;
+    rv32i_decode::decoded_insn d = rv32i_decode::predecode(insn);
+    uint32_t addr = regs.get_unchecked(d.rs1);
 
-    // Check for illegal memory access
-    if(mem.check_illegal(addr, 1))
-    {
-        exec_illegal_insn(insn, pos);
+    if(!exec_atomic(d)) {
+        if(!halt) {
+            exec_illegal_insn(insn, trace);
+        }
         return;
     }
 
-    // Get byte to store
-    uint8_t value = regs.get(rs2) & 0xFF;
-
-    // Store byte to memory
-    mem.set8(addr, value);
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_amo(insn, rv32i_decode::lookup(insn).mnemonic);
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << static_cast<uint32_t>(d.rd) << " = " << hex::to_hex32(regs.get_unchecked(d.rd));
+        // A failed sc.w may never have touched addr, and reading it here
+        // must not fault where the instruction did not
+        if(d.op != rv32i_decode::op_lr_w && static_cast<uint64_t>(addr) + 4 <= mem.get_size()) {
+            os << ", mem[" << hex::to_hex32(addr) << "] = " << hex::to_hex32(mem.get32(addr));
+        }
+        os << std::endl;
+    });
 
-   
     // Increment PC
     pc += 4;
 }
 
 /*************************************************************************
-Function: exec_sh
+Function: exec_lr_w
 
-Use: Executes the SH (Store Halfword) instruction.
+Use: Executes the LR.W (Load Reserved Word) instruction by delegating to exec_amo.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_sh(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_lr_w(uint32_t insn, const Trace &trace)
 {
-    uint32_t rs1 = decoder.get_rs1(insn);
-    uint32_t rs2 = decoder.get_rs2(insn);
-    int32_t imm_s = decoder.get_imm_s(insn);
+    // Delegates to exec_amo
+    exec_amo(insn, trace);
+}
 
-    // Calculate address
-    uint32_t addr = regs.get(rs1) + imm_s;
+/*************************************************************************
+Function: exec_sc_w
 
-    // Check for illegal memory access
-    if(mem.check_illegal(addr, 2))
-    {
-        exec_illegal_insn(insn, pos);
-        return;
-    }
+Use: Executes the SC.W (Store Conditional Word) instruction by delegating to exec_amo.
+
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
+
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_sc_w(uint32_t insn, const Trace &trace)
+{
+    // Delegates to exec_amo
+    exec_amo(insn, trace);
+}
+
+/*************************************************************************
+Function: exec_amoswap_w
 
-    // Get halfword to store
-    uint16_t value = regs.get(rs2) & 0xFFFF;
+Use: Executes the AMOSWAP.W (Atomic Swap Word) instruction by delegating to exec_amo.
 
-    // Store halfword to memory
-    mem.set16(addr, value);
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
-   
-    // Increment PC
-    pc += 4;
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_amoswap_w(uint32_t insn, const Trace &trace)
+{
+    // Delegates to exec_amo
+    exec_amo(insn, trace);
 }
 
 /*************************************************************************
-Function: exec_sw
+Function: exec_amoadd_w
 
-Use: Executes the SW (Store Word) instruction.
+Use: Executes the AMOADD.W (Atomic Add Word) instruction by delegating to exec_amo.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_sw(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_amoadd_w(uint32_t insn, const Trace &trace)
 {
-    uint32_t rs1 = decoder.get_rs1(insn);
-    uint32_t rs2 = decoder.get_rs2(insn);
-    int32_t imm_s = decoder.get_imm_s(insn);
-
-    // Calculate address
-    uint32_t addr = regs.get(rs1) + imm_s;
-
-    // Check for illegal memory access
-    if(mem.check_illegal(addr, 4))
-    {
-        exec_illegal_insn(insn, pos);
-        return;
-    }
+    // Delegates to exec_amo
+    exec_amo(insn, trace);
+}
 
-    // Get word to store
-    uint32_t value = regs.get(rs2);
+/*************************************************************************
+Function: exec_amoxor_w
 
-    // Store word to memory
-    mem.set32(addr, value);
+Use: Executes the AMOXOR.W (Atomic XOR Word) instruction by delegating to exec_amo.
 
-    // Optional rendering
-    if(pos)
-    {
-        std::string s = decoder.render_stype(insn, "sw");
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// mem[" << hex::to_hex32(addr) << "] = " << hex::to_hex32(value) << std::endl;
-    }
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
-    // Increment PC
-    pc += 4;
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_amoxor_w(uint32_t insn, const Trace &trace)
+{
+    // Delegates to exec_amo
+    exec_amo(insn, trace);
 }
 
 /*************************************************************************
-Function: exec_addi
+Function: exec_amoand_w
 
-Use: Executes the ADDI (Add Immediate) instruction.
+Use: Executes the AMOAND.W (Atomic AND Word) instruction by delegating to exec_amo.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_addi(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_amoand_w(uint32_t insn, const Trace &trace)
 {
-    uint32_t rd = decoder.get_rd(insn);
-    uint32_t rs1 = decoder.get_rs1(insn);
-    int32_t imm_i = decoder.get_imm_i(insn);
+    // Delegates to exec_amo
+    exec_amo(insn, trace);
+}
 
-    // Perform addition
-    int32_t result = static_cast<int32_t>(regs.get(rs1)) + imm_i;
+/*************************************************************************
+Function: exec_amoor_w
 
-    // Set rd
-    regs.set(rd, static_cast<uint32_t>(result));
+Use: Executes the AMOOR.W (Atomic OR Word) instruction by delegating to exec_amo.
 
-    // Optional rendering
-    if(pos)
-    {
-        std::string s = decoder.render_itype_alu(insn, "addi", imm_i);
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// x" << rd << " = x" << rs1 << " + " << imm_i 
-             << " = " << hex::to_hex32(static_cast<uint32_t>(result)) << std::endl;
-    }
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
-    // Increment PC
-    pc += 4;
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_amoor_w(uint32_t insn, const Trace &trace)
+{
+    // Delegates to exec_amo
+    exec_amo(insn, trace);
 }
 
 /*************************************************************************
-Function: exec_slti
+Function: exec_amomin_w
 
-Use: Executes the SLTI (Set Less Than Immediate) instruction.
+Use: Executes the AMOMIN.W (Atomic Signed Minimum Word) instruction by delegating to exec_amo.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_slti(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_amomin_w(uint32_t insn, const Trace &trace)
 {
-    uint32_t rd = decoder.get_rd(insn);
-    uint32_t rs1 = decoder.get_rs1(insn);
-    int32_t imm_i = decoder.get_imm_i(insn);
+    // Delegates to exec_amo
+    exec_amo(insn, trace);
+}
 
-    // Perform set less than
-    int32_t value = (static_cast<int32_t>(regs.get(rs1)) < imm_i) ? 1 : 0;
+/*************************************************************************
+Function: exec_amomax_w
 
-    // Set rd
-    regs.set(rd, static_cast<uint32_t>(value));
+Use: Executes the AMOMAX.W (Atomic Signed Maximum Word) instruction by delegating to exec_amo.
 
-    // Optional rendering
-    if(pos)
-    {
-        std::string s = decoder.render_itype_alu(insn, "slti", imm_i);
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// x" << rd << " = (" << static_cast<int32_t>(regs.get(rs1)) 
-             << " < " << imm_i << ") ? 1 : 0 = " << value << std::endl;
-    }
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
-    // Increment PC
-    pc += 4;
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_amomax_w(uint32_t insn, const Trace &trace)
+{
+    // Delegates to exec_amo
+    exec_amo(insn, trace);
 }
 
 /*************************************************************************
-Function: exec_sltiu
+Function: exec_amominu_w
 
-Use: Executes the SLTIU (Set Less Than Immediate Unsigned) instruction.
+Use: Executes the AMOMINU.W (Atomic Unsigned Minimum Word) instruction by delegating to exec_amo.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_sltiu(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_amominu_w(uint32_t insn, const Trace &trace)
 {
-    uint32_t rd = decoder.get_rd(insn);
-    uint32_t rs1 = decoder.get_rs1(insn);
-    uint32_t imm_i = decoder.get_imm_i(insn); // Treat as unsigned
+    // Delegates to exec_amo
+    exec_amo(insn, trace);
+}
 
-    // Perform set less than unsigned
-    uint32_t value = (regs.get(rs1) < static_cast<uint32_t>(imm_i)) ? 1 : 0;
+/*************************************************************************
+Function: exec_amomaxu_w
 
-    // Set rd
-    regs.set(rd, value);
+Use: Executes the AMOMAXU.W (Atomic Unsigned Maximum Word) instruction by delegating to exec_amo.
 
-    // Optional rendering
-    if(pos)
-    {
-        std::string s = decoder.render_itype_alu(insn, "sltiu", imm_i);
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// x" << rd << " = (" << regs.get(rs1) 
-             << " < " << hex::to_hex32(imm_i) << ") ? 1 : 0 = " << value << std::endl;
-    }
+Arguments:
+1. uint32_t insn: The binary representation of the instruction.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
-    // Increment PC
-    pc += 4;
+ ************************************************************************/
+template<typename Trace>
+void rv32i_hart::exec_amomaxu_w(uint32_t insn, const Trace &trace)
+{
+    // Delegates to exec_amo
+    exec_amo(insn, trace);
 }
 
 /*************************************************************************
-Function: exec_xori
+Function: exec_mul
 
-Use: Executes the XORI (Exclusive OR Immediate) instruction.
+Use: Executes the MUL (Multiply) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_xori(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_mul(uint32_t insn, const Trace &trace)
 {
     uint32_t rd = decoder.get_rd(insn);
     uint32_t rs1 = decoder.get_rs1(insn);
-    uint32_t imm_i = decoder.get_imm_i(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
 
-    // Perform XOR
-    uint32_t result = regs.get(rs1) ^ static_cast<uint32_t>(imm_i);
+    // Perform multiplication, keeping the low 32 bits
+    uint32_t result = regs.get_unchecked(rs1) * regs.get_unchecked(rs2);
 
     // Set rd
-    regs.set(rd, result);
+    regs.set_unchecked(rd, result);
 
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_itype_alu(insn, "xori", imm_i);
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// x" << rd << " = x" << rs1 << " ^ " << hex::to_hex0x32(imm_i) 
-             << " = " << hex::to_hex32(result) << std::endl;
-    }
+        std::string s = decoder.render_rtype(insn, "mul");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = x" << rs1 << " * x" << rs2 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
 
     // Increment PC
     pc += 4;
 }
 
 /*************************************************************************
-Function: exec_ori
+Function: exec_mulh
 
-Use: Executes the ORI (OR Immediate) instruction.
+Use: Executes the MULH (Multiply High Signed) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_ori(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_mulh(uint32_t insn, const Trace &trace)
 {
     uint32_t rd = decoder.get_rd(insn);
     uint32_t rs1 = decoder.get_rs1(insn);
-    uint32_t imm_i = decoder.get_imm_i(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
 
-    // Perform OR
-    uint32_t result = regs.get(rs1) | static_cast<uint32_t>(imm_i);
+    // Keep the high 32 bits of the signed product
+    uint32_t result = m_mulh(regs.get_unchecked(rs1), regs.get_unchecked(rs2));
 
     // Set rd
-    regs.set(rd, result);
+    regs.set_unchecked(rd, result);
 
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_itype_alu(insn, "ori", imm_i);
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// x" << rd << " = x" << rs1 << " | " << hex::to_hex0x32(imm_i) 
-             << " = " << hex::to_hex32(result) << std::endl;
-    }
+        std::string s = decoder.render_rtype(insn, "mulh");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = (x" << rs1 << " * x" << rs2 << ") >> 32" 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
 
     // Increment PC
     pc += 4;
 }
 
 /*************************************************************************
-Function: exec_andi
+Function: exec_mulhsu
 
-Use: Executes the ANDI (AND Immediate) instruction.
+Use: Executes the MULHSU (Multiply High Signed x Unsigned) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_andi(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_mulhsu(uint32_t insn, const Trace &trace)
 {
     uint32_t rd = decoder.get_rd(insn);
     uint32_t rs1 = decoder.get_rs1(insn);
-    uint32_t imm_i = decoder.get_imm_i(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
 
-    // Perform AND
-    uint32_t result = regs.get(rs1) & static_cast<uint32_t>(imm_i);
+    // Keep the high 32 bits of the signed by unsigned product
+    uint32_t result = m_mulhsu(regs.get_unchecked(rs1), regs.get_unchecked(rs2));
 
     // Set rd
-    regs.set(rd, result);
+    regs.set_unchecked(rd, result);
 
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_itype_alu(insn, "andi", imm_i);
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// x" << rd << " = x" << rs1 << " & " << hex::to_hex0x32(imm_i) 
-             << " = " << hex::to_hex32(result) << std::endl;
-    }
+        std::string s = decoder.render_rtype(insn, "mulhsu");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = (x" << rs1 << " * (unsigned)x" << rs2 << ") >> 32" 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
 
     // Increment PC
     pc += 4;
 }
 
 /*************************************************************************
-Function: exec_slli
+Function: exec_mulhu
 
-Use: Executes the SLLI (Shift Left Logical Immediate) instruction.
+Use: Executes the MULHU (Multiply High Unsigned) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_slli(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_mulhu(uint32_t insn, const Trace &trace)
 {
     uint32_t rd = decoder.get_rd(insn);
     uint32_t rs1 = decoder.get_rs1(insn);
-    uint32_t shamt = insn & 0x1F; // Shift amount [24:20]
+    uint32_t rs2 = decoder.get_rs2(insn);
 
-    // Perform shift left logical
-    uint32_t result = regs.get(rs1) << shamt;
+    // Keep the high 32 bits of the unsigned product
+    uint32_t result = m_mulhu(regs.get_unchecked(rs1), regs.get_unchecked(rs2));
 
     // Set rd
-    regs.set(rd, result);
+    regs.set_unchecked(rd, result);
 
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_itype_alu(insn, "slli", shamt);
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// x" << rd << " = x" << rs1 << " << " << shamt 
-             << " = " << hex::to_hex32(result) << std::endl;
-    }
+        std::string s = decoder.render_rtype(insn, "mulhu");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = ((unsigned)x" << rs1 << " * (unsigned)x" << rs2 << ") >> 32" 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
 
     // Increment PC
     pc += 4;
 }
 
 /*************************************************************************
-Function: exec_srli_srai
+Function: exec_div
 
-Use: Executes the SRLI (Shift Right Logical Immediate) or SRAI 
-     (Shift Right Arithmetic Immediate) instruction based on funct7.
+Use: Executes the DIV (Divide Signed) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_srli_srai(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_div(uint32_t insn, const Trace &trace)
 {
-    uint32_t funct7 = decoder.get_funct7(insn);
-    uint32_t funct3 = decoder.get_funct3(insn);
     uint32_t rd = decoder.get_rd(insn);
     uint32_t rs1 = decoder.get_rs1(insn);
-    uint32_t shamt = insn & 0x1F; // Shift amount [24:20]
-
-    if(funct7 == rv32i_decode::funct7_srli)
-    {
-        // Perform shift right logical
-        uint32_t result = regs.get(rs1) >> shamt;
-
-        // Set rd
-        regs.set(rd, result);
+    uint32_t rs2 = decoder.get_rs2(insn);
 
-        // Optional rendering
-        if(pos)
-        {
-            std::string s = decoder.render_itype_alu(insn, "srli", shamt);
-            *pos << std::setw(35) << std::setfill(' ') << std::left << s
-                 << "// x" << rd << " = x" << rs1 << " >> " << shamt 
-                 << " = " << hex::to_hex32(result) << std::endl;
-        }
-    }
-    else if(funct7 == rv32i_decode::funct7_srai)
-    {
-        // Perform shift right arithmetic
-        int32_t value = static_cast<int32_t>(regs.get(rs1));
-        int32_t result = value >> shamt;
+    // Perform signed division
+    uint32_t result = m_div(regs.get_unchecked(rs1), regs.get_unchecked(rs2));
 
-        // Set rd
-        regs.set(rd, static_cast<uint32_t>(result));
+    // Set rd
+    regs.set_unchecked(rd, result);
 
-        // Optional rendering
-        if(pos)
-        {
-            std::string s = decoder.render_itype_alu(insn, "srai", shamt);
-            *pos << std::setw(35) << std::setfill(' ') << std::left << s
-                 << "// x" << rd << " = x" << rs1 << " >> " << shamt 
-                 << " = " << hex::to_hex32(static_cast<uint32_t>(result)) << std::endl;
-        }
-    }
-    else
+    // Optional rendering
+    trace.render([&](std::ostream &os)
     {
-        exec_illegal_insn(insn, pos);
-    }
+        std::string s = decoder.render_rtype(insn, "div");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = x" << rs1 << " / x" << rs2 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
 
     // Increment PC
     pc += 4;
 }
 
 /*************************************************************************
-Function: exec_add
+Function: exec_divu
 
-Use: Executes the ADD (Add) instruction.
+Use: Executes the DIVU (Divide Unsigned) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_add(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_divu(uint32_t insn, const Trace &trace)
 {
     uint32_t rd = decoder.get_rd(insn);
     uint32_t rs1 = decoder.get_rs1(insn);
     uint32_t rs2 = decoder.get_rs2(insn);
 
-    // Perform addition
-    uint32_t result = regs.get(rs1) + regs.get(rs2);
+    // Perform unsigned division
+    uint32_t result = m_divu(regs.get_unchecked(rs1), regs.get_unchecked(rs2));
 
     // Set rd
-    regs.set(rd, result);
+    regs.set_unchecked(rd, result);
 
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_rtype(insn, "add");
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// x" << rd << " = x" << rs1 << " + x" << rs2 
-             << " = " << hex::to_hex32(result) << std::endl;
-    }
+        std::string s = decoder.render_rtype(insn, "divu");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = (unsigned)x" << rs1 << " / (unsigned)x" << rs2 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
 
     // Increment PC
     pc += 4;
 }
 
 /*************************************************************************
-Function: exec_sub
+Function: exec_rem
 
-Use: Executes the SUB (Subtract) instruction.
+Use: Executes the REM (Remainder Signed) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_sub(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_rem(uint32_t insn, const Trace &trace)
 {
     uint32_t rd = decoder.get_rd(insn);
     uint32_t rs1 = decoder.get_rs1(insn);
     uint32_t rs2 = decoder.get_rs2(insn);
 
-    // Perform subtraction
-    uint32_t result = regs.get(rs1) - regs.get(rs2);
+    // Take the signed remainder
+    uint32_t result = m_rem(regs.get_unchecked(rs1), regs.get_unchecked(rs2));
 
     // Set rd
-    regs.set(rd, result);
+    regs.set_unchecked(rd, result);
 
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_rtype(insn, "sub");
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// x" << rd << " = x" << rs1 << " - x" << rs2 
-             << " = " << hex::to_hex32(result) << std::endl;
-    }
+        std::string s = decoder.render_rtype(insn, "rem");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = x" << rs1 << " % x" << rs2 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
 
     // Increment PC
     pc += 4;
 }
 
 /*************************************************************************
-Function: exec_sll
+Function: exec_remu
 
-Use: Executes the SLL (Shift Left Logical) instruction.
+Use: Executes the REMU (Remainder Unsigned) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_sll(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_remu(uint32_t insn, const Trace &trace)
 {
     uint32_t rd = decoder.get_rd(insn);
     uint32_t rs1 = decoder.get_rs1(insn);
     uint32_t rs2 = decoder.get_rs2(insn);
 
-    // Perform shift left logical
-    uint32_t shamt = regs.get(rs2) & 0x1F; // Only lower 5 bits used
-    uint32_t result = regs.get(rs1) << shamt;
+    // Take the unsigned remainder
+    uint32_t result = m_remu(regs.get_unchecked(rs1), regs.get_unchecked(rs2));
 
     // Set rd
-    regs.set(rd, result);
+    regs.set_unchecked(rd, result);
 
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_rtype(insn, "sll");
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// x" << rd << " = x" << rs1 << " << " << shamt 
-             << " = " << hex::to_hex32(result) << std::endl;
-    }
+        std::string s = decoder.render_rtype(insn, "remu");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = (unsigned)x" << rs1 << " % (unsigned)x" << rs2 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
 
     // Increment PC
     pc += 4;
 }
 
 /*************************************************************************
-Function: exec_slt
+Function: exec_sh1add
 
-Use: Executes the SLT (Set Less Than) instruction.
+Use: Executes the SH1ADD (Shift Left by 1 and Add) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_slt(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_sh1add(uint32_t insn, const Trace &trace)
 {
     uint32_t rd = decoder.get_rd(insn);
     uint32_t rs1 = decoder.get_rs1(insn);
     uint32_t rs2 = decoder.get_rs2(insn);
 
-    // Perform set less than (signed)
-    int32_t val1 = static_cast<int32_t>(regs.get(rs1));
-    int32_t val2 = static_cast<int32_t>(regs.get(rs2));
-    uint32_t result = (val1 < val2) ? 1 : 0;
+    // Shift and add
+    uint32_t result = (regs.get_unchecked(rs1) << 1) + regs.get_unchecked(rs2);
 
     // Set rd
-    regs.set(rd, result);
+    regs.set_unchecked(rd, result);
 
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_rtype(insn, "slt");
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// x" << rd << " = (" << val1 << " < " << val2 << ") ? 1 : 0 = " 
-             << result << std::endl;
-    }
+        std::string s = decoder.render_rtype(insn, "sh1add");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = (x" << rs1 << " << 1) + x" << rs2 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
 
     // Increment PC
     pc += 4;
 }
 
 /*************************************************************************
-Function: exec_sltu
+Function: exec_sh2add
 
-Use: Executes the SLTU (Set Less Than Unsigned) instruction.
+Use: Executes the SH2ADD (Shift Left by 2 and Add) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_sltu(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_sh2add(uint32_t insn, const Trace &trace)
 {
     uint32_t rd = decoder.get_rd(insn);
     uint32_t rs1 = decoder.get_rs1(insn);
     uint32_t rs2 = decoder.get_rs2(insn);
 
-    // Perform set less than unsigned
-    uint32_t val1 = regs.get(rs1);
-    uint32_t val2 = regs.get(rs2);
-    uint32_t result = (val1 < val2) ? 1 : 0;
+    // Shift and add
+    uint32_t result = (regs.get_unchecked(rs1) << 2) + regs.get_unchecked(rs2);
 
     // Set rd
-    regs.set(rd, result);
+    regs.set_unchecked(rd, result);
 
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_rtype(insn, "sltu");
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// x" << rd << " = (" << hex::to_hex32(val1) 
-             << " < " << hex::to_hex32(val2) << ") ? 1 : 0 = " << result << std::endl;
-    }
+        std::string s = decoder.render_rtype(insn, "sh2add");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = (x" << rs1 << " << 2) + x" << rs2 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
 
     // Increment PC
     pc += 4;
 }
 
 /*************************************************************************
-Function: exec_xor
+Function: exec_sh3add
 
-Use: Executes the XOR (Exclusive OR) instruction.
+Use: Executes the SH3ADD (Shift Left by 3 and Add) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_xor(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_sh3add(uint32_t insn, const Trace &trace)
 {
     uint32_t rd = decoder.get_rd(insn);
     uint32_t rs1 = decoder.get_rs1(insn);
     uint32_t rs2 = decoder.get_rs2(insn);
 
-    // Perform XOR
-    uint32_t result = regs.get(rs1) ^ regs.get(rs2);
+    // Shift and add
+    uint32_t result = (regs.get_unchecked(rs1) << 3) + regs.get_unchecked(rs2);
 
     // Set rd
-    regs.set(rd, result);
+    regs.set_unchecked(rd, result);
 
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_rtype(insn, "xor");
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// x" << rd << " = x" << rs1 << " ^ x" << rs2 
-             << " = " << hex::to_hex32(result) << std::endl;
-    }
+        std::string s = decoder.render_rtype(insn, "sh3add");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = (x" << rs1 << " << 3) + x" << rs2 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
 
     // Increment PC
     pc += 4;
 }
 
 /*************************************************************************
-Function: exec_srl
+Function: exec_andn
 
-Use: Executes the SRL (Shift Right Logical) instruction.
+Use: Executes the ANDN (AND with Inverted Operand) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_srl(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_andn(uint32_t insn, const Trace &trace)
 {
     uint32_t rd = decoder.get_rd(insn);
     uint32_t rs1 = decoder.get_rs1(insn);
     uint32_t rs2 = decoder.get_rs2(insn);
 
-    // Perform shift right logical
-    uint32_t shamt = regs.get(rs2) & 0x1F; // Only lower 5 bits
-    uint32_t result = regs.get(rs1) >> shamt;
+    // Perform AND with the inverse of rs2
+    uint32_t result = regs.get_unchecked(rs1) & ~regs.get_unchecked(rs2);
 
     // Set rd
-    regs.set(rd, result);
+    regs.set_unchecked(rd, result);
 
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_rtype(insn, "srl");
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// x" << rd << " = x" << rs1 << " >> " << shamt 
-             << " = " << hex::to_hex32(result) << std::endl;
-    }
+        std::string s = decoder.render_rtype(insn, "andn");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = x" << rs1 << " & ~x" << rs2 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
 
     // Increment PC
     pc += 4;
 }
 
 /*************************************************************************
-Function: exec_sra
+Function: exec_orn
 
-Use: Executes the SRA (Shift Right Arithmetic) instruction.
+Use: Executes the ORN (OR with Inverted Operand) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_sra(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_orn(uint32_t insn, const Trace &trace)
 {
     uint32_t rd = decoder.get_rd(insn);
     uint32_t rs1 = decoder.get_rs1(insn);
     uint32_t rs2 = decoder.get_rs2(insn);
 
-    // Perform shift right arithmetic
-    uint32_t shamt = regs.get(rs2) & 0x1F; // Only lower 5 bits
-    int32_t value = static_cast<int32_t>(regs.get(rs1));
-    int32_t result = value >> shamt;
+    // Perform OR with the inverse of rs2
+    uint32_t result = regs.get_unchecked(rs1) | ~regs.get_unchecked(rs2);
 
     // Set rd
-    regs.set(rd, static_cast<uint32_t>(result));
+    regs.set_unchecked(rd, result);
 
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_rtype(insn, "sra");
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// x" << rd << " = x" << rs1 << " >> " << shamt 
-             << " = " << hex::to_hex32(static_cast<uint32_t>(result)) << std::endl;
-    }
+        std::string s = decoder.render_rtype(insn, "orn");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = x" << rs1 << " | ~x" << rs2 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
 
     // Increment PC
     pc += 4;
 }
 
 /*************************************************************************
-Function: exec_or
+Function: exec_xnor
 
-Use: Executes the OR (Logical OR) instruction.
+Use: Executes the XNOR (Exclusive NOR) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_or(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_xnor(uint32_t insn, const Trace &trace)
 {
     uint32_t rd = decoder.get_rd(insn);
     uint32_t rs1 = decoder.get_rs1(insn);
     uint32_t rs2 = decoder.get_rs2(insn);
 
-    // Perform OR
-    uint32_t result = regs.get(rs1) | regs.get(rs2);
+    // Perform exclusive NOR
+    uint32_t result = ~(regs.get_unchecked(rs1) ^ regs.get_unchecked(rs2));
 
     // Set rd
-    regs.set(rd, result);
+    regs.set_unchecked(rd, result);
 
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_rtype(insn, "or");
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// x" << rd << " = x" << rs1 << " | x" << rs2 
-             << " = " << hex::to_hex32(result) << std::endl;
-    }
+        std::string s = decoder.render_rtype(insn, "xnor");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = ~(x" << rs1 << " ^ x" << rs2 << ")" 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
 
     // Increment PC
     pc += 4;
 }
 
 /*************************************************************************
-Function: exec_and
+Function: exec_clz
 
-Use: Executes the AND (Logical AND) instruction.
+Use: Executes the CLZ (Count Leading Zeros) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_and(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_clz(uint32_t insn, const Trace &trace)
 {
     uint32_t rd = decoder.get_rd(insn);
     uint32_t rs1 = decoder.get_rs1(insn);
-    uint32_t rs2 = decoder.get_rs2(insn);
 
-    // Perform AND
-    uint32_t result = regs.get(rs1) & regs.get(rs2);
+    // Count leading zero bits, 32 for 0
+    uint32_t result = zb_clz(regs.get_unchecked(rs1));
 
     // Set rd
-    regs.set(rd, result);
+    regs.set_unchecked(rd, result);
 
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_rtype(insn, "and");
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// x" << rd << " = x" << rs1 << " & x" << rs2 
-             << " = " << hex::to_hex32(result) << std::endl;
-    }
+        std::string s = decoder.render_unary(insn, "clz");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = clz(x" << rs1 << ")" 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
 
     // Increment PC
     pc += 4;
 }
 
 /*************************************************************************
-Function: exec_beq
+Function: exec_ctz
 
-Use: Executes the BEQ (Branch if Equal) instruction.
+Use: Executes the CTZ (Count Trailing Zeros) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_beq(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_ctz(uint32_t insn, const Trace &trace)
 {
+    uint32_t rd = decoder.get_rd(insn);
     uint32_t rs1 = decoder.get_rs1(insn);
-    uint32_t rs2 = decoder.get_rs2(insn);
-    int32_t imm_b = decoder.get_imm_b(insn);
 
-    // Check if registers are equal
-    bool condition = (regs.get(rs1) == regs.get(rs2));
+    // Count trailing zero bits, 32 for 0
+    uint32_t result = zb_ctz(regs.get_unchecked(rs1));
 
-    if(condition)
-    {
-        // Branch taken
-        pc += imm_b;
-    }
-    else
-    {
-        // Branch not taken
-        pc += 4;
-    }
+    // Set rd
+    regs.set_unchecked(rd, result);
 
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_btype(pc, insn, "beq");
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// " << (condition ? "branch taken" : "branch not taken") << std::endl;
-    }
+        std::string s = decoder.render_unary(insn, "ctz");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = ctz(x" << rs1 << ")" 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
 }
 
 /*************************************************************************
-Function: exec_bne
+Function: exec_cpop
 
-Use: Executes the BNE (Branch if Not Equal) instruction.
+Use: Executes the CPOP (Count Set Bits) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_bne(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_cpop(uint32_t insn, const Trace &trace)
 {
+    uint32_t rd = decoder.get_rd(insn);
     uint32_t rs1 = decoder.get_rs1(insn);
-    uint32_t rs2 = decoder.get_rs2(insn);
-    int32_t imm_b = decoder.get_imm_b(insn);
 
-    // Check if registers are not equal
-    bool condition = (regs.get(rs1) != regs.get(rs2));
+    // Count set bits
+    uint32_t result = static_cast<uint32_t>(__builtin_popcount(regs.get_unchecked(rs1)));
 
-    if(condition)
-    {
-        // Branch taken
-        pc += imm_b;
-    }
-    else
-    {
-        // Branch not taken
-        pc += 4;
-    }
+    // Set rd
+    regs.set_unchecked(rd, result);
 
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_btype(pc, insn, "bne");
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// " << (condition ? "branch taken" : "branch not taken") << std::endl;
-    }
+        std::string s = decoder.render_unary(insn, "cpop");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = cpop(x" << rs1 << ")" 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
 }
 
 /*************************************************************************
-Function: exec_blt
+Function: exec_sext_b
 
-Use: Executes the BLT (Branch if Less Than) instruction.
+Use: Executes the SEXT.B (Sign Extend Byte) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_blt(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_sext_b(uint32_t insn, const Trace &trace)
 {
+    uint32_t rd = decoder.get_rd(insn);
     uint32_t rs1 = decoder.get_rs1(insn);
-    uint32_t rs2 = decoder.get_rs2(insn);
-    int32_t imm_b = decoder.get_imm_b(insn);
 
-    // Compare as signed integers
-    int32_t val1 = static_cast<int32_t>(regs.get(rs1));
-    int32_t val2 = static_cast<int32_t>(regs.get(rs2));
-    bool condition = (val1 < val2);
+    // Sign extend the low byte
+    uint32_t result = static_cast<uint32_t>(static_cast<int32_t>(static_cast<int8_t>(regs.get_unchecked(rs1))));
 
-    if(condition)
-    {
-        // Branch taken
-        pc += imm_b;
-    }
-    else
-    {
-        // Branch not taken
-        pc += 4;
-    }
+    // Set rd
+    regs.set_unchecked(rd, result);
 
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_btype(pc, insn, "blt");
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// (" << val1 << " < " << val2 << ") = " << condition << std::endl;
-    }
+        std::string s = decoder.render_unary(insn, "sext.b");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = sx(x" << rs1 << " & 0xff)" 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
 }
 
 /*************************************************************************
-Function: exec_bge
+Function: exec_sext_h
 
-Use: Executes the BGE (Branch if Greater or Equal) instruction.
+Use: Executes the SEXT.H (Sign Extend Halfword) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_bge(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_sext_h(uint32_t insn, const Trace &trace)
 {
+    uint32_t rd = decoder.get_rd(insn);
     uint32_t rs1 = decoder.get_rs1(insn);
-    uint32_t rs2 = decoder.get_rs2(insn);
-    int32_t imm_b = decoder.get_imm_b(insn);
 
-    // Compare as signed integers
-    int32_t val1 = static_cast<int32_t>(regs.get(rs1));
-    int32_t val2 = static_cast<int32_t>(regs.get(rs2));
-    bool condition = (val1 >= val2);
+    // Sign extend the low halfword
+    uint32_t result = static_cast<uint32_t>(static_cast<int32_t>(static_cast<int16_t>(regs.get_unchecked(rs1))));
 
-    if(condition)
-    {
-        // Branch taken
-        pc += imm_b;
-    }
-    else
-    {
-        // Branch not taken
-        pc += 4;
-    }
+    // Set rd
+    regs.set_unchecked(rd, result);
 
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_btype(pc, insn, "bge");
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// (" << val1 << " >= " << val2 << ") = " << condition << std::endl;
-    }
+        std::string s = decoder.render_unary(insn, "sext.h");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = sx(x" << rs1 << " & 0xffff)" 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
 }
 
 /*************************************************************************
-Function: exec_bltu
+Function: exec_min
 
-Use: Executes the BLTU (Branch if Less Than Unsigned) instruction.
+Use: Executes the MIN (Signed Minimum) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_bltu(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_min(uint32_t insn, const Trace &trace)
 {
+    uint32_t rd = decoder.get_rd(insn);
     uint32_t rs1 = decoder.get_rs1(insn);
     uint32_t rs2 = decoder.get_rs2(insn);
-    int32_t imm_b = decoder.get_imm_b(insn);
 
-    // Compare as unsigned integers
-    uint32_t val1 = regs.get(rs1);
-    uint32_t val2 = regs.get(rs2);
-    bool condition = (val1 < val2);
+    // Take the signed minimum
+    uint32_t result = static_cast<uint32_t>(std::min(static_cast<int32_t>(regs.get_unchecked(rs1)), static_cast<int32_t>(regs.get_unchecked(rs2))));
 
-    if(condition)
-    {
-        // Branch taken
-        pc += imm_b;
-    }
-    else
-    {
-        // Branch not taken
-        pc += 4;
-    }
+    // Set rd
+    regs.set_unchecked(rd, result);
 
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_btype(pc, insn, "bltu");
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// (" << hex::to_hex32(val1) << " <U " << hex::to_hex32(val2) 
-             << ") = " << condition << std::endl;
-    }
+        std::string s = decoder.render_rtype(insn, "min");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = min(x" << rs1 << ", x" << rs2 << ")" 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
 }
 
 /*************************************************************************
-Function: exec_bgeu
+Function: exec_minu
 
-Use: Executes the BGEU (Branch if Greater or Equal Unsigned) instruction.
+Use: Executes the MINU (Unsigned Minimum) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_bgeu(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_minu(uint32_t insn, const Trace &trace)
 {
+    uint32_t rd = decoder.get_rd(insn);
     uint32_t rs1 = decoder.get_rs1(insn);
     uint32_t rs2 = decoder.get_rs2(insn);
-    int32_t imm_b = decoder.get_imm_b(insn);
 
-    // Compare as unsigned integers
-    uint32_t val1 = regs.get(rs1);
-    uint32_t val2 = regs.get(rs2);
-    bool condition = (val1 >= val2);
+    // Take the unsigned minimum
+    uint32_t result = std::min(regs.get_unchecked(rs1), regs.get_unchecked(rs2));
 
-    if(condition)
-    {
-        // Branch taken
-        pc += imm_b;
-    }
-    else
-    {
-        // Branch not taken
-        pc += 4;
-    }
+    // Set rd
+    regs.set_unchecked(rd, result);
 
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_btype(pc, insn, "bgeu");
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// (" << hex::to_hex32(val1) << " >=U " << hex::to_hex32(val2) 
-             << ") = " << condition << std::endl;
-    }
+        std::string s = decoder.render_rtype(insn, "minu");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = minu(x" << rs1 << ", x" << rs2 << ")" 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
 }
 
 /*************************************************************************
-Function: exec_ecall
+Function: exec_max
 
-Use: Executes the ECALL (Environment Call) instruction.
+Use: Executes the MAX (Signed Maximum) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_ecall(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_max(uint32_t insn, const Trace &trace)
 {
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
+
+    // Take the signed maximum
+    uint32_t result = static_cast<uint32_t>(std::max(static_cast<int32_t>(regs.get_unchecked(rs1)), static_cast<int32_t>(regs.get_unchecked(rs2))));
+
+    // Set rd
+    regs.set_unchecked(rd, result);
+
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_mnemonic("ecall");
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// Environment call" << std::endl;
-    }
+        std::string s = decoder.render_rtype(insn, "max");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = max(x" << rs1 << ", x" << rs2 << ")" 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
 
-    // Define behavior for ECALL, e.g., syscall handling, halt simulation, etc.
-    // For simplicity, we'll halt the simulator
-    halt_simulator("ECALL instruction");
+    // Increment PC
+    pc += 4;
 }
 
 /*************************************************************************
-Function: exec_ebreak
+Function: exec_maxu
 
-Use: Executes the EBREAK (Environment Break) instruction.
+Use: Executes the MAXU (Unsigned Maximum) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_ebreak(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_maxu(uint32_t insn, const Trace &trace)
 {
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
+
+    // Take the unsigned maximum
+    uint32_t result = std::max(regs.get_unchecked(rs1), regs.get_unchecked(rs2));
+
+    // Set rd
+    regs.set_unchecked(rd, result);
+
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_mnemonic("ebreak");
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// Environment break" << std::endl;
-    }
+        std::string s = decoder.render_rtype(insn, "maxu");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = maxu(x" << rs1 << ", x" << rs2 << ")" 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
 
-    // Define behavior for EBREAK, e.g., debug breakpoint, halt simulation, etc.
-    // For simplicity, we'll halt the simulator
-    halt_simulator("EBREAK instruction");
+    // Increment PC
+    pc += 4;
 }
 
 /*************************************************************************
-Function: exec_system
+Function: exec_zext_h
 
-Use: Executes system instructions like ECALL, EBREAK, and CSR operations.
+Use: Executes the ZEXT.H (Zero Extend Halfword) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_system(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_zext_h(uint32_t insn, const Trace &trace)
 {
-    uint32_t imm = (insn >> 20) & 0xFFF; // Immediate field for system instructions
-    uint32_t funct3 = decoder.get_funct3(insn);
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
 
-    if(imm == rv32i_decode::ecall_imm && funct3 == 0x0)
-    {
-        exec_ecall(insn, pos);
-    }
-    else if(imm == rv32i_decode::ebreak_imm && funct3 == 0x0)
-    {
-        exec_ebreak(insn, pos);
-    }
-    else if(funct3 == rv32i_decode::funct3_csrrw ||
-            funct3 == rv32i_decode::funct3_csrrs ||
-            funct3 == rv32i_decode::funct3_csrrc ||
-            funct3 == rv32i_decode::funct3_csrrwi ||
-            funct3 == rv32i_decode::funct3_csrrsi ||
-            funct3 == rv32i_decode::funct3_csrrci)
-    {
-        // Handle CSR operations
-        if(funct3 == rv32i_decode::funct3_csrrw ||
-           funct3 == rv32i_decode::funct3_csrrs ||
-           funct3 == rv32i_decode::funct3_csrrc)
-        {
-            exec_csrrx(insn, pos);
-        }
-        else if(funct3 == rv32i_decode::funct3_csrrwi ||
-                funct3 == rv32i_decode::funct3_csrrsi ||
-                funct3 == rv32i_decode::funct3_csrrci)
-        {
-            exec_csrrxi(insn, pos);
-        }
-        else
-        {
-            exec_illegal_insn(insn, pos);
-        }
-    }
-    else
+    // Zero extend the low halfword
+    uint32_t result = regs.get_unchecked(rs1) & 0xFFFF;
+
+    // Set rd
+    regs.set_unchecked(rd, result);
+
+    // Optional rendering
+    trace.render([&](std::ostream &os)
     {
-        exec_illegal_insn(insn, pos);
-    }
+        std::string s = decoder.render_unary(insn, "zext.h");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = x" << rs1 << " & 0xffff" 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
+
+    // Increment PC
+    pc += 4;
 }
 
 /*************************************************************************
-Function: exec_csrrx
+Function: exec_rol
 
-Use: Executes CSR Read/Write, Read/Set, and Read/Clear instructions.
+Use: Executes the ROL (Rotate Left) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_csrrx(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_rol(uint32_t insn, const Trace &trace)
 {
     uint32_t rd = decoder.get_rd(insn);
     uint32_t rs1 = decoder.get_rs1(insn);
-    uint32_t csr = (insn >> 20) & 0xFFF; // CSR address
-
-    std::string mnemonic;
-    if(decoder.get_funct3(insn) == rv32i_decode::funct3_csrrw)
-        mnemonic = "csrrw";
-    else if(decoder.get_funct3(insn) == rv32i_decode::funct3_csrrs)
-        mnemonic = "csrrs";
-    else if(decoder.get_funct3(insn) == rv32i_decode::funct3_csrrc)
-        mnemonic = "csrrc";
-
-    // Retrieve current CSR value; default to 0 if not present
-    uint32_t csr_val = (csr_map.find(csr) != csr_map.end()) ? csr_map[csr] : 0;
-
-    uint32_t new_csr_val = csr_val;
-    uint32_t rs1_val = regs.get(rs1);
+    uint32_t rs2 = decoder.get_rs2(insn);
 
-    if(mnemonic == "csrrw")
-    {
-        // Swap CSR and rs1
-        new_csr_val = rs1_val;
-        regs.set(rd, csr_val);
-    }
-    else if(mnemonic == "csrrs")
-    {
-        // Set CSR = CSR | rs1
-        new_csr_val = csr_val | rs1_val;
-        regs.set(rd, csr_val);
-    }
-    else if(mnemonic == "csrrc")
-    {
-        // Set CSR = CSR & ~rs1
-        new_csr_val = csr_val & ~rs1_val;
-        regs.set(rd, csr_val);
-    }
-    else
-    {
-        exec_illegal_insn(insn, pos);
-        return;
-    }
+    // Rotate left
+    uint32_t result = zb_rol(regs.get_unchecked(rs1), regs.get_unchecked(rs2));
 
-    // Update CSR
-    csr_map[csr] = new_csr_val;
+    // Set rd
+    regs.set_unchecked(rd, result);
 
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_csrrx(insn, mnemonic);
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// x" << rd << " = " << hex::to_hex32(csr_val) 
-             << ", CSR[" << hex::to_hex32(csr) << "] = " << hex::to_hex32(new_csr_val) << std::endl;
-    }
+        std::string s = decoder.render_rtype(insn, "rol");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = x" << rs1 << " rol x" << rs2 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
 
     // Increment PC
     pc += 4;
 }
 
 /*************************************************************************
-Function: exec_csrrxi
+Function: exec_ror
 
-Use: Executes CSR Read/Write Immediate, Read/Set Immediate, and 
-     Read/Clear Immediate instructions.
+Use: Executes the ROR (Rotate Right) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_csrrxi(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_ror(uint32_t insn, const Trace &trace)
 {
     uint32_t rd = decoder.get_rd(insn);
-    uint32_t zimm = decoder.get_rs1(insn); // Zero-extended immediate
-    uint32_t csr = (insn >> 20) & 0xFFF;  // CSR address
-
-    std::string mnemonic;
-    if(decoder.get_funct3(insn) == rv32i_decode::funct3_csrrwi)
-        mnemonic = "csrrwi";
-    else if(decoder.get_funct3(insn) == rv32i_decode::funct3_csrrsi)
-        mnemonic = "csrrsi";
-    else if(decoder.get_funct3(insn) == rv32i_decode::funct3_csrrci)
-        mnemonic = "csrrci";
-    else
-    {
-        exec_illegal_insn(insn, pos);
-        return;
-    }
-
-    // Retrieve current CSR value; default to 0 if not present
-    uint32_t csr_val = (csr_map.find(csr) != csr_map.end()) ? csr_map[csr] : 0;
-
-    uint32_t new_csr_val = csr_val;
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t rs2 = decoder.get_rs2(insn);
 
-    if(mnemonic == "csrrwi")
-    {
-        // Swap CSR and zimm (treated as rs1 = zimm)
-        new_csr_val = zimm;
-        regs.set(rd, csr_val);
-    }
-    else if(mnemonic == "csrrsi")
-    {
-        // Set CSR = CSR | zimm
-        new_csr_val = csr_val | zimm;
-        regs.set(rd, csr_val);
-    }
-    else if(mnemonic == "csrrci")
-    {
-        // Set CSR = CSR & ~zimm
-        new_csr_val = csr_val & ~zimm;
-        regs.set(rd, csr_val);
-    }
+    // Rotate right
+    uint32_t result = zb_ror(regs.get_unchecked(rs1), regs.get_unchecked(rs2));
 
-    // Update CSR
-    csr_map[csr] = new_csr_val;
+    // Set rd
+    regs.set_unchecked(rd, result);
 
     // Optional rendering
-    if(pos)
+    trace.render([&](std::ostream &os)
     {
-        std::string s = decoder.render_csrrxi(insn, mnemonic);
-        *pos << std::setw(35) << std::setfill(' ') << std::left << s
-             << "// x" << rd << " = " << hex::to_hex32(csr_val) 
-             << ", CSR[" << hex::to_hex32(csr) << "] = " << hex::to_hex32(new_csr_val) << std::endl;
-    }
+        std::string s = decoder.render_rtype(insn, "ror");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = x" << rs1 << " ror x" << rs2 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
 
     // Increment PC
     pc += 4;
 }
 
 /*************************************************************************
-Function: exec_csrrw
+Function: exec_rori
 
-Use: Executes the CSR Read/Write instruction by delegating to exec_csrrx.
+Use: Executes the RORI (Rotate Right Immediate) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_csrrw(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_rori(uint32_t insn, const Trace &trace)
 {
-    // Delegates to exec_csrrx
-    exec_csrrx(insn, pos);
-}
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
+    uint32_t shamt = decoder.get_rs2(insn); // Rotate amount [24:20]
 
-/*************************************************************************
-Function: exec_csrrs
+    // Rotate right
+    uint32_t result = zb_ror(regs.get_unchecked(rs1), shamt);
 
-Use: Executes the CSR Read/Set instruction by delegating to exec_csrrx.
+    // Set rd
+    regs.set_unchecked(rd, result);
 
-Arguments:
-1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_itype_alu(insn, "rori", shamt);
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = x" << rs1 << " ror " << shamt 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
 
- ************************************************************************/
-void rv32i_hart::exec_csrrs(uint32_t insn, std::ostream* pos)
-{
-    // Delegates to exec_csrrx
-    exec_csrrx(insn, pos);
+    // Increment PC
+    pc += 4;
 }
 
 /*************************************************************************
-Function: exec_csrrc
+Function: exec_rev8
 
-Use: Executes the CSR Read/Clear instruction by delegating to exec_csrrx.
+Use: Executes the REV8 (Byte Reverse) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_csrrc(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_rev8(uint32_t insn, const Trace &trace)
 {
-    // Delegates to exec_csrrx
-    exec_csrrx(insn, pos);
-}
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
 
-/*************************************************************************
-Function: exec_csrrwi
+    // Reverse the byte order
+    uint32_t result = __builtin_bswap32(regs.get_unchecked(rs1));
 
-Use: Executes the CSR Read/Write Immediate instruction by delegating to exec_csrrxi.
+    // Set rd
+    regs.set_unchecked(rd, result);
 
-Arguments:
-1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_unary(insn, "rev8");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = rev8(x" << rs1 << ")" 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
 
- ************************************************************************/
-void rv32i_hart::exec_csrrwi(uint32_t insn, std::ostream* pos)
-{
-    // Delegates to exec_csrrxi
-    exec_csrrxi(insn, pos);
+    // Increment PC
+    pc += 4;
 }
 
 /*************************************************************************
-Function: exec_csrrsi
+Function: exec_orc_b
 
-Use: Executes the CSR Read/Set Immediate instruction by delegating to exec_csrrxi.
+Use: Executes the ORC.B (OR Combine Bytes) instruction.
 
 Arguments:
 1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+2. const Trace &trace: The tracing policy that renders it, if any.
 
  ************************************************************************/
-void rv32i_hart::exec_csrrsi(uint32_t insn, std::ostream* pos)
+template<typename Trace>
+void rv32i_hart::exec_orc_b(uint32_t insn, const Trace &trace)
 {
-    // Delegates to exec_csrrxi
-    exec_csrrxi(insn, pos);
-}
+    uint32_t rd = decoder.get_rd(insn);
+    uint32_t rs1 = decoder.get_rs1(insn);
 
-/*************************************************************************
-Function: exec_csrrci
+    // Set each byte to all ones if any of its bits is set
+    uint32_t result = zb_orc_b(regs.get_unchecked(rs1));
 
-Use: Executes the CSR Read/Clear Immediate instruction by delegating to exec_csrrxi.
+    // Set rd
+    regs.set_unchecked(rd, result);
 
-Arguments:
-1. uint32_t insn: The binary representation of the instruction.
-2. std::ostream* pos: Optional output stream for logging/disassembly.
+    // Optional rendering
+    trace.render([&](std::ostream &os)
+    {
+        std::string s = decoder.render_unary(insn, "orc.b");
+        os << std::setw(35) << std::setfill(' ') << std::left << s
+           << "// x" << rd << " = orc.b(x" << rs1 << ")" 
+           << " = " << hex::to_hex32(result) << std::endl;
+    });
 
- ************************************************************************/
-void rv32i_hart::exec_csrrci(uint32_t insn, std::ostream* pos)
-{
-    // Delegates to exec_csrrxi
-    exec_csrrxi(insn, pos);
+    // Increment PC
+    pc += 4;
 }
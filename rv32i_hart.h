@@ -14,105 +14,200 @@
 #include <cstdint>
 #include <string>
 #include <unordered_map>
+#include <vector>
+#include <deque>
 #include <iostream>
+#include <chrono>
 
-// Forward declarations of dependent classes
-class rv32i_decode;
-class registerfile;
-class memory;
-
-// Namespace for hexadecimal utility functions
-namespace hex {
-    // Assume these functions are defined in hex.h/cpp
-    std::string to_hex0x32(uint32_t val);
-    std::string to_hex0x16(uint16_t val);
-    std::string to_hex0x8(uint8_t val);
-    std::string to_hex32(uint32_t val);
-}
+#include "memory.h"
+#include "rv32i_decode.h"
+#include "registerfile.h"
+#include "rv32i_jit.h"
 
 // rv32i_hart Class Definition
 class rv32i_hart {
 public:
     // Constructor
-    rv32i_hart();
+    rv32i_hart(memory &m);
+
+    // Simulator state
+    void reset();
+    void dump(const std::string &hdr = "") const;
+    uint64_t get_insn_counter() const;
+    void set_mhartid(int i);
+    void set_show_instructions(bool b) { show_instructions = b; }
+    void set_show_registers(bool b) { show_registers = b; }
+
+    // Execute one instruction at pc
+    void tick(const std::string &hdr = "");
+
+    // How run() executes instructions when not tracing, the threaded core
+    // needs computed goto and falls back to tick() without it
+    enum exec_core
+    {
+        core_switch,    // one tick() per instruction
+        core_threaded,  // direct threaded dispatch over predecoded instructions
+        core_block      // chained basic blocks out of a translation cache
+    };
+    void set_core(exec_core c) { core = c; }
+    exec_core get_core() const { return core; }
+
+    // Execute until halted or limit instructions have run, 0 for no limit
+    uint64_t run(uint64_t limit = 0);
+
+    // Let core_block translate hot blocks to host code, where supported
+    void set_jit(bool b) { use_jit = b && rv32i_jit::is_supported(); }
+    bool get_jit() const { return use_jit; }
+
+    // Tracing policies the exec_xxx() helpers are instantiated for.
+    // no_trace compiles every rendering away, stream_trace writes it to
+    // a stream in the format tick() prints with show_instructions
+    struct no_trace
+    {
+        template<typename F> void render(const F &) const {}
+    };
+    struct stream_trace
+    {
+        explicit stream_trace(std::ostream &os) : os(os) {}
+        template<typename F> void render(const F &f) const { f(os); }
+        std::ostream &os;
+    };
 
-    // Main execution function
+    // Main execution function, renders to pos when it is given
     void exec(uint32_t insn, std::ostream* pos = nullptr);
 
-    // Execution functions for each instruction type
+    // Execute a predecoded instruction, the untraced fast path
+    void exec_decoded(const rv32i_decode::decoded_insn &d);
+    static bool is_control(uint8_t op);
+    void flush_icache();
+
+    // Execution functions for each instruction type, one exec_<name> for
+    // every entry in RV32_INSNS
     // U-Type Instructions
-    void exec_lui(uint32_t insn, std::ostream* pos);
-    void exec_auipc(uint32_t insn, std::ostream* pos);
+    template<typename Trace> void exec_lui(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_auipc(uint32_t insn, const Trace &trace);
 
     // J-Type Instruction
-    void exec_jal(uint32_t insn, std::ostream* pos);
+    template<typename Trace> void exec_jal(uint32_t insn, const Trace &trace);
 
     // I-Type Instructions
-    void exec_jalr(uint32_t insn, std::ostream* pos);
-    void exec_lb(uint32_t insn, std::ostream* pos);
-    void exec_lh(uint32_t insn, std::ostream* pos);
-    void exec_lw(uint32_t insn, std::ostream* pos);
-    void exec_lbu(uint32_t insn, std::ostream* pos);
-    void exec_lhu(uint32_t insn, std::ostream* pos);
-    void exec_sb(uint32_t insn, std::ostream* pos);
-    void exec_sh(uint32_t insn, std::ostream* pos);
-    void exec_sw(uint32_t insn, std::ostream* pos);
-    void exec_addi(uint32_t insn, std::ostream* pos);
-    void exec_slti(uint32_t insn, std::ostream* pos);
-    void exec_sltiu(uint32_t insn, std::ostream* pos);
-    void exec_xori(uint32_t insn, std::ostream* pos);
-    void exec_ori(uint32_t insn, std::ostream* pos);
-    void exec_andi(uint32_t insn, std::ostream* pos);
-    void exec_slli(uint32_t insn, std::ostream* pos);
-    void exec_srli_srai(uint32_t insn, std::ostream* pos);
+    template<typename Trace> void exec_jalr(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_lb(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_lh(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_lw(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_lbu(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_lhu(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_sb(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_sh(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_sw(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_addi(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_slti(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_sltiu(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_xori(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_ori(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_andi(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_slli(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_srli(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_srai(uint32_t insn, const Trace &trace);
 
     // R-Type Instructions
-    void exec_add(uint32_t insn, std::ostream* pos);
-    void exec_sub(uint32_t insn, std::ostream* pos);
-    void exec_sll(uint32_t insn, std::ostream* pos);
-    void exec_slt(uint32_t insn, std::ostream* pos);
-    void exec_sltu(uint32_t insn, std::ostream* pos);
-    void exec_xor(uint32_t insn, std::ostream* pos);
-    void exec_srl(uint32_t insn, std::ostream* pos);
-    void exec_sra(uint32_t insn, std::ostream* pos);
-    void exec_or(uint32_t insn, std::ostream* pos);
-    void exec_and(uint32_t insn, std::ostream* pos);
+    template<typename Trace> void exec_add(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_sub(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_sll(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_slt(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_sltu(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_xor(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_srl(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_sra(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_or(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_and(uint32_t insn, const Trace &trace);
 
     // B-Type Instructions (Branches)
-    void exec_beq(uint32_t insn, std::ostream* pos);
-    void exec_bne(uint32_t insn, std::ostream* pos);
-    void exec_blt(uint32_t insn, std::ostream* pos);
-    void exec_bge(uint32_t insn, std::ostream* pos);
-    void exec_bltu(uint32_t insn, std::ostream* pos);
-    void exec_bgeu(uint32_t insn, std::ostream* pos);
+    template<typename Trace> void exec_beq(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_bne(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_blt(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_bge(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_bltu(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_bgeu(uint32_t insn, const Trace &trace);
 
     // System Instructions
-    void exec_ecall(uint32_t insn, std::ostream* pos);
-    void exec_ebreak(uint32_t insn, std::ostream* pos);
-    void exec_system(uint32_t insn, std::ostream* pos);
+    template<typename Trace> void exec_ecall(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_ebreak(uint32_t insn, const Trace &trace);
 
     // CSR Instructions
-    void exec_csrrx(uint32_t insn, std::ostream* pos);
-    void exec_csrrxi(uint32_t insn, std::ostream* pos);
-    void exec_csrrw(uint32_t insn, std::ostream* pos);   // Delegates to exec_csrrx
-    void exec_csrrs(uint32_t insn, std::ostream* pos);   // Delegates to exec_csrrx
-    void exec_csrrc(uint32_t insn, std::ostream* pos);   // Delegates to exec_csrrx
-    void exec_csrrwi(uint32_t insn, std::ostream* pos);  // Delegates to exec_csrrxi
-    void exec_csrrsi(uint32_t insn, std::ostream* pos);  // Delegates to exec_csrrxi
-    void exec_csrrci(uint32_t insn, std::ostream* pos);  // Delegates to exec_csrrxi
+    template<typename Trace> void exec_csrrx(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_csrrxi(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_csrrw(uint32_t insn, const Trace &trace);   // Delegates to exec_csrrx
+    template<typename Trace> void exec_csrrs(uint32_t insn, const Trace &trace);   // Delegates to exec_csrrx
+    template<typename Trace> void exec_csrrc(uint32_t insn, const Trace &trace);   // Delegates to exec_csrrx
+    template<typename Trace> void exec_csrrwi(uint32_t insn, const Trace &trace);  // Delegates to exec_csrrxi
+    template<typename Trace> void exec_csrrsi(uint32_t insn, const Trace &trace);  // Delegates to exec_csrrxi
+    template<typename Trace> void exec_csrrci(uint32_t insn, const Trace &trace);  // Delegates to exec_csrrxi
+
+    // A Extension Instructions
+    template<typename Trace> void exec_amo(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_lr_w(uint32_t insn, const Trace &trace);       // Delegates to exec_amo
+    template<typename Trace> void exec_sc_w(uint32_t insn, const Trace &trace);       // Delegates to exec_amo
+    template<typename Trace> void exec_amoswap_w(uint32_t insn, const Trace &trace);  // Delegates to exec_amo
+    template<typename Trace> void exec_amoadd_w(uint32_t insn, const Trace &trace);   // Delegates to exec_amo
+    template<typename Trace> void exec_amoxor_w(uint32_t insn, const Trace &trace);   // Delegates to exec_amo
+    template<typename Trace> void exec_amoand_w(uint32_t insn, const Trace &trace);   // Delegates to exec_amo
+    template<typename Trace> void exec_amoor_w(uint32_t insn, const Trace &trace);    // Delegates to exec_amo
+    template<typename Trace> void exec_amomin_w(uint32_t insn, const Trace &trace);   // Delegates to exec_amo
+    template<typename Trace> void exec_amomax_w(uint32_t insn, const Trace &trace);   // Delegates to exec_amo
+    template<typename Trace> void exec_amominu_w(uint32_t insn, const Trace &trace);  // Delegates to exec_amo
+    template<typename Trace> void exec_amomaxu_w(uint32_t insn, const Trace &trace);  // Delegates to exec_amo
+
+    // M Extension Instructions
+    template<typename Trace> void exec_mul(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_mulh(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_mulhsu(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_mulhu(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_div(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_divu(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_rem(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_remu(uint32_t insn, const Trace &trace);
+
+    // Zba and Zbb Extension Instructions
+    template<typename Trace> void exec_sh1add(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_sh2add(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_sh3add(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_andn(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_orn(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_xnor(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_clz(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_ctz(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_cpop(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_sext_b(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_sext_h(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_min(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_minu(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_max(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_maxu(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_zext_h(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_rol(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_ror(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_rori(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_rev8(uint32_t insn, const Trace &trace);
+    template<typename Trace> void exec_orc_b(uint32_t insn, const Trace &trace);
 
     // Illegal Instruction Handler
-    void exec_illegal_insn(uint32_t insn, std::ostream* pos);
+    template<typename Trace> void exec_illegal_insn(uint32_t insn, const Trace &trace);
 
     // Simulator Control
     void halt_simulator(const std::string& reason);
 
     // Accessors
     uint32_t get_pc() const { return pc; }
+    void set_pc(uint32_t new_pc) { pc = new_pc; }   // e.g. an ELF entry point
     bool is_halted() const { return halt; }
     std::string get_halt_reason() const { return halt_reason; }
+    const memory::fault& get_last_fault() const { return last_fault; }
 
 private:
+    // Ahead of time translated code runs on the hart's state directly
+    friend class rv32i_aot;
+
     // Member Variables
     uint32_t pc;  // Program Counter
     bool halt;    // Halt flag
@@ -120,9 +215,104 @@ private:
 
     rv32i_decode decoder;    // Instruction decoder
     registerfile regs;       // Register file
-    memory mem;               // Memory
+    memory &mem;              // Memory
+
+    // CSRs, one slot per 12 bit CSR number. Most of them just hold what
+    // was last written, the ones with a hook are computed on read instead
+    static const uint32_t csr_count = 4096;
+    static const uint32_t csr_cycle   = 0xc00;
+    static const uint32_t csr_time    = 0xc01;
+    static const uint32_t csr_instret = 0xc02;
+    static const uint32_t csr_cycleh  = 0xc80;
+    static const uint32_t csr_timeh   = 0xc81;
+    static const uint32_t csr_instreth = 0xc82;
+    static const uint32_t csr_mhartid = 0xf14;
+
+    typedef uint32_t (rv32i_hart::*csr_read_fn)(uint32_t csr) const;
+    typedef void (rv32i_hart::*csr_write_fn)(uint32_t csr, uint32_t val);
+    struct csr_hook
+    {
+        csr_read_fn read;
+        csr_write_fn write;
+    };
+    static const csr_hook counter_hook;
+    static const csr_hook time_hook;
+    static const csr_hook mhartid_hook;
+
+    std::vector<uint32_t> csrs;
+    std::vector<const csr_hook *> csr_hooks;            // nullptr for a plain CSR
+    std::chrono::steady_clock::time_point time_base;    // time reads 0 here
+
+    uint32_t csr_read(uint32_t csr) const;
+    void csr_write(uint32_t csr, uint32_t val);
+    uint32_t read_counter(uint32_t csr) const;
+    uint32_t read_time(uint32_t csr) const;
+    uint32_t read_mhartid(uint32_t csr) const;
+    void write_read_only(uint32_t csr, uint32_t val);
+
+    uint64_t insn_counter;   // Instructions executed since reset
+    int mhartid;             // Value of the mhartid CSR
+    bool show_instructions;  // Trace each instruction as it executes
+    bool show_registers;     // Dump the registers before each instruction
+
+    // The lr.w reservation. sc.w succeeds if the word still holds what
+    // lr.w read, which a host compare and swap checks, so no store has to
+    // look at reservations and harts on other threads need no lock
+    bool reserved;
+    uint32_t reserved_addr;
+    uint32_t reserved_val;
+
+    memory::fault last_fault = {};  // Last out of range access that halted the hart
+
+    // Predecoded instructions, direct mapped on pc and dropped whenever
+    // memory reports a write to a page they were decoded from
+    static const uint32_t icache_size = 4096;
+    std::vector<rv32i_decode::decoded_insn> icache;
+    uint64_t icache_epoch;
+    const rv32i_decode::decoded_insn &icache_fill();
+
+    exec_core core;
+    void run_threaded(uint64_t limit);
+
+    template<typename Trace> void exec_insn(uint32_t insn, const Trace &trace);
+
+    bool exec_straight(const rv32i_decode::decoded_insn &d);
+    bool exec_atomic(const rv32i_decode::decoded_insn &d);
+    void exec_control(const rv32i_decode::decoded_insn &d);
+
+    // A basic block: the predecoded instructions from pc up to and
+    // including the first control op, chained to the blocks that
+    // followed it last time
+    struct block
+    {
+        uint32_t pc;                // address of the first instruction
+        uint32_t straight;          // leading instructions that fall through
+        bool ends_in_control;       // whether the last one goes to exec_control()
+        std::vector<rv32i_decode::decoded_insn> insns;
+        uint32_t chain_pc[2];       // [0] falling off the end, [1] anywhere else
+        block *chain[2];
+        uint32_t heat;              // times run, until it is translated
+        rv32i_jit::block_fn code;   // the translation, if any
+        uint32_t code_insns;        // how many instructions it covers
+    };
+    static const uint32_t max_block_insns = 64;
+    static const uint32_t jit_threshold = 16;
+
+    // The translation cache, dropped along with the icache
+    std::deque<block> blocks;
+    std::unordered_map<uint32_t, block *> block_map;
+    block *cur_block;                               // where a guarded fault
+    const rv32i_decode::decoded_insn *cur_insn;     // leaves run_blocks()
+    block *find_block();
+    void run_blocks(uint64_t limit);
 
-    std::unordered_map<uint32_t, uint32_t> csr_map; // CSR address to value mapping
+    // Translated code, used by run_blocks() for blocks that get hot
+    rv32i_jit jit;
+    rv32i_jit::context jit_ctx;
+    bool use_jit;
+    bool in_jit;                // a guarded fault came from translated code
+    uint64_t run_translated(block *b);
+    void take_mem_fault(uint32_t insn_pc);
 };
 
 #endif // RV32I_HART_H
\ No newline at end of file
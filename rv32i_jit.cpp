@@ -0,0 +1,703 @@
+//*************************************************************************
+// Ryan Scaglione
+// z1996413
+// CSCI463 - PE1
+//
+// I certify that this is my own work, and where applicable an extension
+// of the starter code for the assignment
+//
+//*************************************************************************
+
+/*************************************************************************
+rv32i_jit.cpp
+
+Implementation of the rv32i_jit class, an x86-64 translator for the
+straight line part of a basic block plus its jump or branch.
+
+Generated code follows the System V calling convention:
+    rdi     context * on entry
+    rbx     guest registers (context::regs)
+    r12     context *
+    r13     memory * (context::mem)
+Guest values are loaded into eax/ecx/edx/esi as needed and stored right
+back, so nothing is cached across instructions and a helper call never
+has to spill guest state.
+
+*************************************************************************/
+
+#include "rv32i_jit.h"
+#include <cstring>
+#include <vector>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__x86_64__)
+
+/*************************************************************************
+Memory helpers called from generated code. Loads return the value in
+the low 32 bits, or bit 32 set when the interpreter has to take the
+access (paged memory, out of range) so that the fault is recorded the
+usual way. Stores return a context status.
+ ************************************************************************/
+static inline bool jit_out_of_range(const memory *m, uint32_t addr, uint32_t len)
+{
+    return !m->is_guarded() && static_cast<uint64_t>(addr) + len > m->get_size();
+}
+
+static uint64_t jit_lb(memory *m, uint32_t addr)
+{
+    if(jit_out_of_range(m, addr, 1))
+        return 1ull << 32;
+    return static_cast<uint32_t>(m->get8_sx(addr));
+}
+
+static uint64_t jit_lh(memory *m, uint32_t addr)
+{
+    if(jit_out_of_range(m, addr, 2))
+        return 1ull << 32;
+    return static_cast<uint32_t>(m->get16_sx(addr));
+}
+
+static uint64_t jit_lw(memory *m, uint32_t addr)
+{
+    if(jit_out_of_range(m, addr, 4))
+        return 1ull << 32;
+    return m->get32(addr);
+}
+
+static uint64_t jit_lbu(memory *m, uint32_t addr)
+{
+    if(jit_out_of_range(m, addr, 1))
+        return 1ull << 32;
+    return m->get8(addr);
+}
+
+static uint64_t jit_lhu(memory *m, uint32_t addr)
+{
+    if(jit_out_of_range(m, addr, 2))
+        return 1ull << 32;
+    return m->get16(addr);
+}
+
+static uint32_t jit_sb(memory *m, uint32_t addr, uint32_t val)
+{
+    if(jit_out_of_range(m, addr, 1))
+        return rv32i_jit::jit_bail;
+    uint64_t epoch = m->get_code_epoch();
+    m->set8(addr, val & 0xFF);
+    return m->get_code_epoch() == epoch ? rv32i_jit::jit_done : rv32i_jit::jit_code_written;
+}
+
+static uint32_t jit_sh(memory *m, uint32_t addr, uint32_t val)
+{
+    if(jit_out_of_range(m, addr, 2))
+        return rv32i_jit::jit_bail;
+    uint64_t epoch = m->get_code_epoch();
+    m->set16(addr, val & 0xFFFF);
+    return m->get_code_epoch() == epoch ? rv32i_jit::jit_done : rv32i_jit::jit_code_written;
+}
+
+static uint32_t jit_sw(memory *m, uint32_t addr, uint32_t val)
+{
+    if(jit_out_of_range(m, addr, 4))
+        return rv32i_jit::jit_bail;
+    uint64_t epoch = m->get_code_epoch();
+    m->set32(addr, val);
+    return m->get_code_epoch() == epoch ? rv32i_jit::jit_done : rv32i_jit::jit_code_written;
+}
+
+/*************************************************************************
+Class: emitter
+
+Use: Appends x86-64 instructions to a byte buffer. Only the handful of
+     encodings the translator needs are here.
+
+*************************************************************************/
+class emitter
+{
+public:
+    std::vector<uint8_t> buf;
+
+    void b(uint8_t v) { buf.push_back(v); }
+    void d32(uint32_t v) { for(int i = 0; i < 4; i++) b(static_cast<uint8_t>(v >> (8 * i))); }
+    void d64(uint64_t v) { for(int i = 0; i < 8; i++) b(static_cast<uint8_t>(v >> (8 * i))); }
+
+    // 32 bit host register numbers used below
+    enum reg { eax = 0, ecx = 1, edx = 2, esi = 6 };
+
+    // mov r32, [rbx + 4*guest]
+    void load_guest(reg r, uint32_t guest) { b(0x8B); b(0x43 | (r << 3)); b(4 * guest); }
+    // mov [rbx + 4*guest], r32, writes to x0 are dropped
+    void store_guest(uint32_t guest, reg r) { if(guest) { b(0x89); b(0x43 | (r << 3)); b(4 * guest); } }
+    // mov dword [rbx + 4*guest], imm32
+    void store_guest_imm(uint32_t guest, uint32_t imm) { if(guest) { b(0xC7); b(0x43); b(4 * guest); d32(imm); } }
+    // <op> eax, [rbx + 4*guest], op is the r/m32 form opcode
+    void alu_guest(uint8_t op, uint32_t guest) { b(op); b(0x43); b(4 * guest); }
+    // <op> eax, imm32, op is the short eax form opcode
+    void alu_imm(uint8_t op, uint32_t imm) { b(op); d32(imm); }
+    // movsxd r64, dword [rbx + 4*guest]
+    void load_guest_sx64(reg r, uint32_t guest) { b(0x48); b(0x63); b(0x43 | (r << 3)); b(4 * guest); }
+    // imul eax, [rbx + 4*guest]
+    void imul_guest(uint32_t guest) { b(0x0F); b(0xAF); b(0x43); b(4 * guest); }
+    // rol/ror/shl/shr/sar eax, imm8 (ext 0/1/4/5/7)
+    void shift_imm(uint8_t ext, uint32_t n) { b(0xC1); b(0xC0 | (ext << 3)); b(n & 0x1F); }
+    // rol/ror/shl/shr/sar eax, cl
+    void shift_cl(uint8_t ext) { b(0xD3); b(0xC0 | (ext << 3)); }
+    // setcc al; movzx eax, al
+    void setcc_eax(uint8_t cc) { b(0x0F); b(0x90 | cc); b(0xC0); b(0x0F); b(0xB6); b(0xC0); }
+    // mov r32, imm32
+    void mov_imm(reg r, uint32_t imm) { b(0xB8 | r); d32(imm); }
+    // mov dword [r12 + off], imm32
+    void store_ctx_imm(uint8_t off, uint32_t imm) { b(0x41); b(0xC7); b(0x44); b(0x24); b(off); d32(imm); }
+    // mov [r12 + off], r32
+    void store_ctx(uint8_t off, reg r) { b(0x41); b(0x89); b(0x44 | (r << 3)); b(0x24); b(off); }
+    // mov rax, fn; call rax
+    void call(const void *fn) { b(0x48); b(0xB8); d64(reinterpret_cast<uint64_t>(fn)); b(0xFF); b(0xD0); }
+    // jcc rel32 to be patched, returns the offset of the rel32
+    size_t jcc(uint8_t cc) { b(0x0F); b(0x80 | cc); d32(0); return buf.size() - 4; }
+    size_t jmp() { b(0xE9); d32(0); return buf.size() - 4; }
+    void patch(size_t at, size_t target)
+    {
+        uint32_t rel = static_cast<uint32_t>(target - (at + 4));
+        memcpy(&buf[at], &rel, 4);
+    }
+};
+
+// x86 condition codes
+static const uint8_t cc_b = 0x2, cc_ae = 0x3, cc_e = 0x4, cc_ne = 0x5, cc_a = 0x7, cc_l = 0xC, cc_ge = 0xD, cc_g = 0xF;
+
+// r/m32 forms of the two operand ALU ops, and their short eax, imm32 forms
+static const uint8_t op_add = 0x03, op_sub = 0x2B, op_xor = 0x33, op_or = 0x0B, op_and = 0x23, op_cmp = 0x3B;
+static const uint8_t opi_add = 0x05, opi_xor = 0x35, opi_or = 0x0D, opi_and = 0x25, opi_cmp = 0x3D;
+
+// shift group extensions
+static const uint8_t sh_rol = 0, sh_ror = 1, sh_shl = 4, sh_shr = 5, sh_sar = 7;
+
+static const uint8_t ctx_count = offsetof(rv32i_jit::context, count);
+static const uint8_t ctx_next_pc = offsetof(rv32i_jit::context, next_pc);
+
+#endif
+
+/*************************************************************************
+Function: rv32i_jit
+
+Use: Constructor. The code cache is mapped on the first compile so that
+     harts that never translate anything do not pay for it.
+
+Arguments:
+1. size_t cache_size: Bytes of executable memory to use for code.
+
+ ************************************************************************/
+rv32i_jit::rv32i_jit(size_t cache_size) : cache(nullptr), cache_size(cache_size), used(0)
+{
+}
+
+/*************************************************************************
+Function: ~rv32i_jit
+
+Use: Destructor, unmaps the code cache.
+
+ ************************************************************************/
+rv32i_jit::~rv32i_jit()
+{
+    if(cache != nullptr) {
+        munmap(cache, cache_size);
+    }
+}
+
+/*************************************************************************
+Function: is_supported
+
+Use: Tells whether this host can run translated code at all.
+
+Returns: bool: true on x86-64.
+
+ ************************************************************************/
+bool rv32i_jit::is_supported()
+{
+#if defined(__x86_64__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*************************************************************************
+Function: can_translate
+
+Use: Tells whether compile() emits code for an operation. A block should
+     end at the first one it does not, so that the op is run by the
+     interpreter as the block's last instruction.
+
+Arguments:
+1. uint8_t op: The rv32i_decode::insn_op to classify.
+
+Returns: bool: false for system, CSR, illegal and the A extension ops.
+
+ ************************************************************************/
+bool rv32i_jit::can_translate(uint8_t op)
+{
+    switch(rv32i_decode::get_spec(static_cast<rv32i_decode::insn_op>(op)).fmt) {
+        case rv32i_decode::fmt_mnemonic:
+        case rv32i_decode::fmt_csrrx:
+        case rv32i_decode::fmt_csrrxi:
+        case rv32i_decode::fmt_lr:
+        case rv32i_decode::fmt_amo:
+        case rv32i_decode::fmt_illegal:
+            return false;
+        default:
+            return true;
+    }
+}
+
+/*************************************************************************
+Function: flush
+
+Use: Throws away every translation. Any block_fn handed out before is
+     dangling afterwards.
+
+ ************************************************************************/
+void rv32i_jit::flush()
+{
+    used = 0;
+}
+
+/*************************************************************************
+Function: compile
+
+Use: Translates a run of predecoded instructions. Everything that falls
+     through is translated, and so is a final jal, jalr or branch.
+     Translation stops at the first op can_translate() turns down.
+
+Arguments:
+1. const rv32i_decode::decoded_insn *insns: The instructions, in order,
+   each one's pc set.
+2. uint32_t n: How many there are.
+3. uint32_t &compiled: Set to how many of them the code covers.
+
+Returns: block_fn: The translation, or nullptr if there is nothing worth
+     translating, the host is not supported, or the cache is full.
+
+Notes: the translation always sets context::count and next_pc. On
+     jit_done that is the end of what was compiled, on jit_bail it is
+     the access the interpreter must run, on jit_code_written it is the
+     instruction after the store.
+
+ ************************************************************************/
+rv32i_jit::block_fn rv32i_jit::compile(const rv32i_decode::decoded_insn *insns, uint32_t n, uint32_t &compiled)
+{
+    compiled = 0;
+#if defined(__x86_64__)
+    if(cache == nullptr) {
+        // never writable and executable at once, see the copy below
+        void *p = mmap(nullptr, cache_size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if(p == MAP_FAILED) {
+            cache_size = 0;
+            return nullptr;
+        }
+        cache = static_cast<uint8_t *>(p);
+    }
+    if(cache_size == 0) {
+        return nullptr;
+    }
+
+    emitter e;
+
+    // Exits taken from the middle of the block, patched once the stubs
+    // at the end are laid down
+    struct side_exit
+    {
+        size_t jump;    // rel32 to patch
+        uint32_t index; // instruction it leaves at
+        bool store;     // eax holds a store status rather than a bail
+    };
+    std::vector<side_exit> exits;
+
+    // push rbx; push r12; push r13, which leaves rsp 16 byte aligned
+    e.b(0x53); e.b(0x41); e.b(0x54); e.b(0x41); e.b(0x55);
+    // mov r12, rdi
+    e.b(0x49); e.b(0x89); e.b(0xFC);
+    // mov rbx, [rdi + regs]; mov r13, [rdi + mem]
+    e.b(0x48); e.b(0x8B); e.b(0x5F); e.b(offsetof(context, regs));
+    e.b(0x4C); e.b(0x8B); e.b(0x6F); e.b(offsetof(context, mem));
+
+    uint32_t i = 0;
+    bool jumped = false;
+    for(; i < n && !jumped; i++) {
+        const rv32i_decode::decoded_insn &d = insns[i];
+        uint32_t imm = static_cast<uint32_t>(d.imm);
+
+        switch(d.op) {
+            case rv32i_decode::op_lui:
+                e.store_guest_imm(d.rd, imm);
+                break;
+            case rv32i_decode::op_auipc:
+                e.store_guest_imm(d.rd, d.pc + imm);
+                break;
+
+            case rv32i_decode::op_addi:  e.load_guest(emitter::eax, d.rs1); e.alu_imm(opi_add, imm); e.store_guest(d.rd, emitter::eax); break;
+            case rv32i_decode::op_xori:  e.load_guest(emitter::eax, d.rs1); e.alu_imm(opi_xor, imm); e.store_guest(d.rd, emitter::eax); break;
+            case rv32i_decode::op_ori:   e.load_guest(emitter::eax, d.rs1); e.alu_imm(opi_or, imm);  e.store_guest(d.rd, emitter::eax); break;
+            case rv32i_decode::op_andi:  e.load_guest(emitter::eax, d.rs1); e.alu_imm(opi_and, imm); e.store_guest(d.rd, emitter::eax); break;
+            case rv32i_decode::op_slti:  e.load_guest(emitter::eax, d.rs1); e.alu_imm(opi_cmp, imm); e.setcc_eax(cc_l); e.store_guest(d.rd, emitter::eax); break;
+            case rv32i_decode::op_sltiu: e.load_guest(emitter::eax, d.rs1); e.alu_imm(opi_cmp, imm); e.setcc_eax(cc_b); e.store_guest(d.rd, emitter::eax); break;
+            case rv32i_decode::op_slli:  e.load_guest(emitter::eax, d.rs1); e.shift_imm(sh_shl, imm); e.store_guest(d.rd, emitter::eax); break;
+            case rv32i_decode::op_srli:  e.load_guest(emitter::eax, d.rs1); e.shift_imm(sh_shr, imm); e.store_guest(d.rd, emitter::eax); break;
+            case rv32i_decode::op_srai:  e.load_guest(emitter::eax, d.rs1); e.shift_imm(sh_sar, imm); e.store_guest(d.rd, emitter::eax); break;
+
+            case rv32i_decode::op_add:   e.load_guest(emitter::eax, d.rs1); e.alu_guest(op_add, d.rs2); e.store_guest(d.rd, emitter::eax); break;
+            case rv32i_decode::op_sub:   e.load_guest(emitter::eax, d.rs1); e.alu_guest(op_sub, d.rs2); e.store_guest(d.rd, emitter::eax); break;
+            case rv32i_decode::op_xor:   e.load_guest(emitter::eax, d.rs1); e.alu_guest(op_xor, d.rs2); e.store_guest(d.rd, emitter::eax); break;
+            case rv32i_decode::op_or:    e.load_guest(emitter::eax, d.rs1); e.alu_guest(op_or, d.rs2);  e.store_guest(d.rd, emitter::eax); break;
+            case rv32i_decode::op_and:   e.load_guest(emitter::eax, d.rs1); e.alu_guest(op_and, d.rs2); e.store_guest(d.rd, emitter::eax); break;
+            case rv32i_decode::op_slt:   e.load_guest(emitter::eax, d.rs1); e.alu_guest(op_cmp, d.rs2); e.setcc_eax(cc_l); e.store_guest(d.rd, emitter::eax); break;
+            case rv32i_decode::op_sltu:  e.load_guest(emitter::eax, d.rs1); e.alu_guest(op_cmp, d.rs2); e.setcc_eax(cc_b); e.store_guest(d.rd, emitter::eax); break;
+
+            // x86 masks 32 bit shift counts in cl to 5 bits, as RV32I does
+            case rv32i_decode::op_sll:   e.load_guest(emitter::eax, d.rs1); e.load_guest(emitter::ecx, d.rs2); e.shift_cl(sh_shl); e.store_guest(d.rd, emitter::eax); break;
+            case rv32i_decode::op_srl:   e.load_guest(emitter::eax, d.rs1); e.load_guest(emitter::ecx, d.rs2); e.shift_cl(sh_shr); e.store_guest(d.rd, emitter::eax); break;
+            case rv32i_decode::op_sra:   e.load_guest(emitter::eax, d.rs1); e.load_guest(emitter::ecx, d.rs2); e.shift_cl(sh_sar); e.store_guest(d.rd, emitter::eax); break;
+
+            // The high products multiply the operands widened to 64 bits,
+            // the low 64 bits come out the same signed or not
+            case rv32i_decode::op_mul:   e.load_guest(emitter::eax, d.rs1); e.imul_guest(d.rs2); e.store_guest(d.rd, emitter::eax); break;
+            case rv32i_decode::op_mulh:
+            case rv32i_decode::op_mulhsu:
+            case rv32i_decode::op_mulhu:
+                if(d.op == rv32i_decode::op_mulhu)
+                    e.load_guest(emitter::eax, d.rs1);
+                else
+                    e.load_guest_sx64(emitter::eax, d.rs1);
+                if(d.op == rv32i_decode::op_mulh)
+                    e.load_guest_sx64(emitter::ecx, d.rs2);
+                else
+                    e.load_guest(emitter::ecx, d.rs2);
+                // imul rax, rcx; shr rax, 32
+                e.b(0x48); e.b(0x0F); e.b(0xAF); e.b(0xC1);
+                e.b(0x48); e.b(0xC1); e.b(0xE8); e.b(32);
+                e.store_guest(d.rd, emitter::eax);
+                break;
+
+            // Zba and Zbb. lzcnt, tzcnt and popcnt are not baseline x86-64,
+            // so clz and ctz use bsr/bsf, which leave 0 to a branch, and
+            // cpop and orc.b are done with masks and adds
+            case rv32i_decode::op_clz:
+            case rv32i_decode::op_ctz:
+            {
+                e.load_guest(emitter::ecx, d.rs1);
+                e.mov_imm(emitter::eax, 32);
+                // test ecx, ecx; jz zero
+                e.b(0x85); e.b(0xC9);
+                size_t zero = e.jcc(cc_e);
+                if(d.op == rv32i_decode::op_clz) {
+                    // bsr eax, ecx; xor eax, 31
+                    e.b(0x0F); e.b(0xBD); e.b(0xC1);
+                    e.b(0x83); e.b(0xF0); e.b(0x1F);
+                }
+                else {
+                    e.b(0x0F); e.b(0xBC); e.b(0xC1);    // bsf eax, ecx
+                }
+                e.patch(zero, e.buf.size());
+                e.store_guest(d.rd, emitter::eax);
+                break;
+            }
+            case rv32i_decode::op_cpop:
+                e.load_guest(emitter::eax, d.rs1);
+                // pairs, nibbles, bytes, then the byte sums add up in the top byte
+                e.b(0x89); e.b(0xC1);                   // mov ecx, eax
+                e.b(0xD1); e.b(0xE9);                   // shr ecx, 1
+                e.b(0x81); e.b(0xE1); e.d32(0x55555555); // and ecx, 0x55555555
+                e.b(0x29); e.b(0xC8);                   // sub eax, ecx
+                e.b(0x89); e.b(0xC1);                   // mov ecx, eax
+                e.b(0x81); e.b(0xE1); e.d32(0x33333333); // and ecx, 0x33333333
+                e.shift_imm(sh_shr, 2);
+                e.alu_imm(opi_and, 0x33333333);
+                e.b(0x01); e.b(0xC8);                   // add eax, ecx
+                e.b(0x89); e.b(0xC1);                   // mov ecx, eax
+                e.b(0xC1); e.b(0xE9); e.b(4);           // shr ecx, 4
+                e.b(0x01); e.b(0xC8);                   // add eax, ecx
+                e.alu_imm(opi_and, 0x0f0f0f0f);
+                e.b(0x69); e.b(0xC0); e.d32(0x01010101); // imul eax, eax, 0x01010101
+                e.shift_imm(sh_shr, 24);
+                e.store_guest(d.rd, emitter::eax);
+                break;
+            case rv32i_decode::op_orc_b:
+                // bit 7 of each byte is set when any bit of it is, adding
+                // 0x7f to the low 7 bits never carries into the next byte
+                e.load_guest(emitter::eax, d.rs1);
+                e.b(0x89); e.b(0xC1);                   // mov ecx, eax
+                e.alu_imm(opi_and, 0x7f7f7f7f);
+                e.alu_imm(opi_add, 0x7f7f7f7f);
+                e.b(0x09); e.b(0xC8);                   // or eax, ecx
+                e.alu_imm(opi_and, 0x80808080);
+                e.shift_imm(sh_shr, 7);
+                e.b(0x69); e.b(0xC0); e.d32(0xff);      // imul eax, eax, 0xff
+                e.store_guest(d.rd, emitter::eax);
+                break;
+            case rv32i_decode::op_sh1add:
+            case rv32i_decode::op_sh2add:
+            case rv32i_decode::op_sh3add:
+                e.load_guest(emitter::eax, d.rs1);
+                e.shift_imm(sh_shl, d.op == rv32i_decode::op_sh1add ? 1 : d.op == rv32i_decode::op_sh2add ? 2 : 3);
+                e.alu_guest(op_add, d.rs2);
+                e.store_guest(d.rd, emitter::eax);
+                break;
+            case rv32i_decode::op_andn:
+            case rv32i_decode::op_orn:
+                e.load_guest(emitter::eax, d.rs2);
+                e.b(0xF7); e.b(0xD0);               // not eax
+                e.alu_guest(d.op == rv32i_decode::op_andn ? op_and : op_or, d.rs1);
+                e.store_guest(d.rd, emitter::eax);
+                break;
+            case rv32i_decode::op_xnor:
+                e.load_guest(emitter::eax, d.rs1);
+                e.alu_guest(op_xor, d.rs2);
+                e.b(0xF7); e.b(0xD0);               // not eax
+                e.store_guest(d.rd, emitter::eax);
+                break;
+            case rv32i_decode::op_min:
+            case rv32i_decode::op_minu:
+            case rv32i_decode::op_max:
+            case rv32i_decode::op_maxu:
+            {
+                // rs2 replaces rs1 when rs1 is the wrong side of it
+                uint8_t cc = d.op == rv32i_decode::op_min ? cc_g
+                           : d.op == rv32i_decode::op_minu ? cc_a
+                           : d.op == rv32i_decode::op_max ? cc_l : cc_b;
+                e.load_guest(emitter::eax, d.rs1);
+                e.load_guest(emitter::ecx, d.rs2);
+                // cmp eax, ecx; cmovcc eax, ecx
+                e.b(0x39); e.b(0xC8);
+                e.b(0x0F); e.b(0x40 | cc); e.b(0xC1);
+                e.store_guest(d.rd, emitter::eax);
+                break;
+            }
+            case rv32i_decode::op_sext_b:
+            case rv32i_decode::op_sext_h:
+            case rv32i_decode::op_zext_h:
+                e.load_guest(emitter::eax, d.rs1);
+                // movsx eax, al / movsx eax, ax / movzx eax, ax
+                e.b(0x0F);
+                e.b(d.op == rv32i_decode::op_sext_b ? 0xBE : d.op == rv32i_decode::op_sext_h ? 0xBF : 0xB7);
+                e.b(0xC0);
+                e.store_guest(d.rd, emitter::eax);
+                break;
+            case rv32i_decode::op_rol:   e.load_guest(emitter::eax, d.rs1); e.load_guest(emitter::ecx, d.rs2); e.shift_cl(sh_rol); e.store_guest(d.rd, emitter::eax); break;
+            case rv32i_decode::op_ror:   e.load_guest(emitter::eax, d.rs1); e.load_guest(emitter::ecx, d.rs2); e.shift_cl(sh_ror); e.store_guest(d.rd, emitter::eax); break;
+            case rv32i_decode::op_rori:  e.load_guest(emitter::eax, d.rs1); e.shift_imm(sh_ror, imm); e.store_guest(d.rd, emitter::eax); break;
+            case rv32i_decode::op_rev8:
+                e.load_guest(emitter::eax, d.rs1);
+                e.b(0x0F); e.b(0xC8);               // bswap eax
+                e.store_guest(d.rd, emitter::eax);
+                break;
+
+            // The cases the host divide would fault on are branched
+            // around: by zero the quotient is all ones and the remainder
+            // the dividend, INT_MIN / -1 is INT_MIN remainder 0
+            case rv32i_decode::op_div:
+            case rv32i_decode::op_divu:
+            case rv32i_decode::op_rem:
+            case rv32i_decode::op_remu:
+            {
+                bool is_signed = d.op == rv32i_decode::op_div || d.op == rv32i_decode::op_rem;
+                bool is_rem = d.op == rv32i_decode::op_rem || d.op == rv32i_decode::op_remu;
+                e.load_guest(emitter::eax, d.rs1);
+                e.load_guest(emitter::ecx, d.rs2);
+                // test ecx, ecx; jz by_zero
+                e.b(0x85); e.b(0xC9);
+                size_t by_zero = e.jcc(cc_e);
+                size_t overflow = 0;
+                if(is_signed) {
+                    // cmp ecx, -1; jne divide; cmp eax, INT_MIN; je overflow
+                    e.b(0x83); e.b(0xF9); e.b(0xFF);
+                    size_t divide = e.jcc(cc_ne);
+                    e.alu_imm(opi_cmp, 0x80000000);
+                    overflow = e.jcc(cc_e);
+                    e.patch(divide, e.buf.size());
+                    // cdq; idiv ecx
+                    e.b(0x99); e.b(0xF7); e.b(0xF9);
+                }
+                else {
+                    // xor edx, edx; div ecx
+                    e.b(0x31); e.b(0xD2); e.b(0xF7); e.b(0xF1);
+                }
+                if(is_rem) {
+                    e.b(0x89); e.b(0xD0);           // mov eax, edx
+                }
+                size_t divided = e.jmp();
+                // eax still holds the dividend, which is the remainder by
+                // zero and the quotient of INT_MIN / -1
+                e.patch(by_zero, e.buf.size());
+                if(!is_rem) {
+                    e.mov_imm(emitter::eax, 0xffffffff);
+                }
+                if(is_signed && is_rem) {
+                    size_t zero_done = e.jmp();
+                    e.patch(overflow, e.buf.size());
+                    e.b(0x31); e.b(0xC0);           // xor eax, eax
+                    e.patch(zero_done, e.buf.size());
+                }
+                else if(is_signed) {
+                    e.patch(overflow, e.buf.size());
+                }
+                e.patch(divided, e.buf.size());
+                e.store_guest(d.rd, emitter::eax);
+                break;
+            }
+
+            case rv32i_decode::op_lb:
+            case rv32i_decode::op_lh:
+            case rv32i_decode::op_lw:
+            case rv32i_decode::op_lbu:
+            case rv32i_decode::op_lhu:
+            {
+                const void *fn = d.op == rv32i_decode::op_lb ? reinterpret_cast<const void *>(&jit_lb)
+                               : d.op == rv32i_decode::op_lh ? reinterpret_cast<const void *>(&jit_lh)
+                               : d.op == rv32i_decode::op_lw ? reinterpret_cast<const void *>(&jit_lw)
+                               : d.op == rv32i_decode::op_lbu ? reinterpret_cast<const void *>(&jit_lbu)
+                               : reinterpret_cast<const void *>(&jit_lhu);
+                // a guarded fault inside the helper finds the access here
+                e.store_ctx_imm(ctx_count, i);
+                // mov rdi, r13; esi = rs1 + imm
+                e.b(0x4C); e.b(0x89); e.b(0xEF);
+                e.load_guest(emitter::esi, d.rs1);
+                e.b(0x81); e.b(0xC6); e.d32(imm);
+                e.call(fn);
+                // mov rdx, rax; shr rdx, 32; jnz bail
+                e.b(0x48); e.b(0x89); e.b(0xC2);
+                e.b(0x48); e.b(0xC1); e.b(0xEA); e.b(32);
+                exits.push_back({ e.jcc(cc_ne), i, false });
+                e.store_guest(d.rd, emitter::eax);
+                break;
+            }
+
+            case rv32i_decode::op_sb:
+            case rv32i_decode::op_sh:
+            case rv32i_decode::op_sw:
+            {
+                const void *fn = d.op == rv32i_decode::op_sb ? reinterpret_cast<const void *>(&jit_sb)
+                               : d.op == rv32i_decode::op_sh ? reinterpret_cast<const void *>(&jit_sh)
+                               : reinterpret_cast<const void *>(&jit_sw);
+                e.store_ctx_imm(ctx_count, i);
+                e.b(0x4C); e.b(0x89); e.b(0xEF);
+                e.load_guest(emitter::esi, d.rs1);
+                e.b(0x81); e.b(0xC6); e.d32(imm);
+                e.load_guest(emitter::edx, d.rs2);
+                e.call(fn);
+                // test eax, eax; jnz exit
+                e.b(0x85); e.b(0xC0);
+                exits.push_back({ e.jcc(cc_ne), i, true });
+                break;
+            }
+
+            case rv32i_decode::op_jal:
+                e.store_guest_imm(d.rd, d.pc + 4);
+                e.store_ctx_imm(ctx_next_pc, d.pc + imm);
+                jumped = true;
+                break;
+            case rv32i_decode::op_jalr:
+                // the target is taken before rd is written, rd may be rs1
+                e.load_guest(emitter::eax, d.rs1);
+                e.alu_imm(opi_add, imm);
+                e.b(0x83); e.b(0xE0); e.b(0xFE);    // and eax, ~1
+                e.store_guest_imm(d.rd, d.pc + 4);
+                e.store_ctx(ctx_next_pc, emitter::eax);
+                jumped = true;
+                break;
+
+            case rv32i_decode::op_beq:
+            case rv32i_decode::op_bne:
+            case rv32i_decode::op_blt:
+            case rv32i_decode::op_bge:
+            case rv32i_decode::op_bltu:
+            case rv32i_decode::op_bgeu:
+            {
+                uint8_t cc = d.op == rv32i_decode::op_beq ? cc_e
+                           : d.op == rv32i_decode::op_bne ? cc_ne
+                           : d.op == rv32i_decode::op_blt ? cc_l
+                           : d.op == rv32i_decode::op_bge ? cc_ge
+                           : d.op == rv32i_decode::op_bltu ? cc_b : cc_ae;
+                e.load_guest(emitter::eax, d.rs1);
+                e.alu_guest(op_cmp, d.rs2);
+                e.mov_imm(emitter::ecx, d.pc + 4);
+                e.mov_imm(emitter::edx, d.pc + imm);
+                // cmovcc ecx, edx
+                e.b(0x0F); e.b(0x40 | cc); e.b(0xCA);
+                e.store_ctx(ctx_next_pc, emitter::ecx);
+                jumped = true;
+                break;
+            }
+
+            default:
+                // what can_translate() turns down stays with the interpreter
+                goto done;
+        }
+    }
+done:
+    compiled = i;
+    if(compiled == 0) {
+        return nullptr;
+    }
+
+    // Falling off the end of what was compiled
+    e.store_ctx_imm(ctx_count, compiled);
+    if(!jumped) {
+        e.store_ctx_imm(ctx_next_pc, insns[compiled - 1].pc + 4);
+    }
+    e.b(0x31); e.b(0xC0);                   // xor eax, eax
+    size_t epilogue = e.buf.size();
+    e.b(0x41); e.b(0x5D); e.b(0x41); e.b(0x5C); e.b(0x5B); e.b(0xC3);
+
+    for(const side_exit &x : exits) {
+        e.patch(x.jump, e.buf.size());
+        size_t bail = 0;
+        if(x.store) {
+            // cmp eax, jit_bail; je bail; otherwise the store hit code
+            e.b(0x83); e.b(0xF8); e.b(jit_bail);
+            bail = e.jcc(cc_e);
+            e.store_ctx_imm(ctx_count, x.index + 1);
+            e.store_ctx_imm(ctx_next_pc, insns[x.index].pc + 4);
+            e.mov_imm(emitter::eax, jit_code_written);
+            e.patch(e.jmp(), epilogue);
+            e.patch(bail, e.buf.size());
+        }
+        e.store_ctx_imm(ctx_count, x.index);
+        e.store_ctx_imm(ctx_next_pc, insns[x.index].pc);
+        e.mov_imm(emitter::eax, jit_bail);
+        e.patch(e.jmp(), epilogue);
+    }
+
+    // Branches are relative, so the buffer can be copied anywhere
+    size_t start = (used + 15) & ~static_cast<size_t>(15);
+    if(start + e.buf.size() > cache_size) {
+        compiled = 0;
+        return nullptr;
+    }
+
+    // The pages the block lands on are made writable only for the copy.
+    // Earlier blocks sharing the first page are not running meanwhile,
+    // the cache belongs to the one hart that is compiling
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t first = start & ~(page - 1);
+    size_t last = (start + e.buf.size() + page - 1) & ~(page - 1);
+    if(mprotect(cache + first, last - first, PROT_READ | PROT_WRITE) != 0) {
+        compiled = 0;
+        return nullptr;
+    }
+    memcpy(cache + start, e.buf.data(), e.buf.size());
+    if(mprotect(cache + first, last - first, PROT_READ | PROT_EXEC) != 0) {
+        // a host that will not execute it gets no more translations,
+        // the cache just looks full from here on
+        used = cache_size;
+        compiled = 0;
+        return nullptr;
+    }
+    used = start + e.buf.size();
+    return reinterpret_cast<block_fn>(cache + start);
+#else
+    (void)insns;
+    (void)n;
+    return nullptr;
+#endif
+}
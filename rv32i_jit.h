@@ -0,0 +1,70 @@
+//*************************************************************************
+// Ryan Scaglione
+// z1996413
+// CSCI463 - PE1
+//
+// I certify that this is my own work, and where applicable an extension
+// of the starter code for the assignment
+//
+//*************************************************************************
+
+/*************************************************************************
+Class: rv32i_jit
+
+Use: Translates runs of predecoded RV32I instructions into x86-64 machine
+     code in an executable code cache. Guest registers stay in the
+     registerfile, which the generated code reaches through a pinned
+     context, and every load and store calls memory.
+
+*************************************************************************/
+
+#ifndef RV32I_JIT_H
+#define RV32I_JIT_H
+
+#include <cstdint>
+#include <cstddef>
+
+#include "memory.h"
+#include "rv32i_decode.h"
+
+class rv32i_jit
+{
+public:
+    // What generated code works on, and where it says how far it got
+    struct context
+    {
+        uint32_t *regs;     // guest x0..x31, x0 is never written
+        memory *mem;
+        uint32_t count;     // instructions completed
+        uint32_t next_pc;   // where the guest goes next
+    };
+
+    // Why generated code returned
+    enum status
+    {
+        jit_done = 0,           // ran everything that was compiled
+        jit_bail = 1,           // stopped before an access the interpreter must handle
+        jit_code_written = 2    // stopped after a store into predecoded code
+    };
+
+    typedef uint32_t (*block_fn)(context *ctx);
+
+    static const size_t default_cache_size = 16u << 20;
+
+    rv32i_jit(size_t cache_size = default_cache_size);
+    ~rv32i_jit();
+    rv32i_jit(const rv32i_jit &) = delete;
+    rv32i_jit &operator=(const rv32i_jit &) = delete;
+
+    static bool is_supported();
+    static bool can_translate(uint8_t op);
+    block_fn compile(const rv32i_decode::decoded_insn *insns, uint32_t n, uint32_t &compiled);
+    void flush();
+
+private:
+    uint8_t *cache;
+    size_t cache_size;
+    size_t used;
+};
+
+#endif // RV32I_JIT_H